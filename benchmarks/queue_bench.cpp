@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+
+// Compares the request submission queue of the connections (MPSCQueue)
+// with the boost::lockfree::queue used before. N producer threads push
+// preallocated items while a single consumer thread takes them, the way
+// user threads hand requests to the IO thread. The consumer either pops
+// one item at a time or takes everything available at once
+// (consume_all() / drain()), the latter is what the connections do.
+//
+// Contention only shows with a core per producer: on a machine with fewer
+// cores the producers mostly take turns, so such numbers do not tell how
+// the queues compare under load.
+//
+// usage: queue_bench [items per run]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <boost/lockfree/queue.hpp>
+
+#include "Basics/cpu-relax.h"
+#include "MPSCQueue.h"
+
+namespace fu = ::arangodb::fuerte;
+
+namespace {
+
+struct Item : public fu::MPSCQueueHook {
+  std::size_t value = 0;
+};
+
+// same type as the connections used: fixed size, no allocation on push
+struct BoostQueue {
+  boost::lockfree::queue<Item*, boost::lockfree::capacity<1024>> queue;
+  void push(Item* item) {
+    // the connections failed the request when full, here the producer
+    // waits for the consumer instead
+    while (!queue.push(item)) {
+      std::this_thread::yield();
+    }
+  }
+  Item* pop() {
+    Item* item = nullptr;
+    return queue.pop(item) ? item : nullptr;
+  }
+  template <typename F>
+  std::size_t drain(F&& f) {
+    return queue.consume_all(f);
+  }
+};
+
+struct IntrusiveQueue {
+  fu::MPSCQueue<Item> queue;
+  void push(Item* item) { queue.push(item); }
+  Item* pop() { return queue.pop(); }
+  template <typename F>
+  std::size_t drain(F&& f) {
+    return queue.drain(f);
+  }
+};
+
+/// @return million items per second
+template <typename Q, bool Batch>
+double run(std::size_t producers, std::size_t total) {
+  Q q;
+  std::vector<Item> items(total);
+  std::atomic<bool> go(false);
+  std::size_t const perThread = total / producers;
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < producers; t++) {
+    threads.emplace_back([&, t] {
+      while (!go.load(std::memory_order_acquire)) {
+        fu::cpu_relax();
+      }
+      Item* begin = items.data() + t * perThread;
+      for (std::size_t i = 0; i < perThread; i++) {
+        q.push(begin + i);
+      }
+    });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+
+  std::size_t const expected = perThread * producers;
+  std::size_t popped = 0, sum = 0;
+  while (popped < expected) {
+    if constexpr (Batch) {
+      std::size_t n = q.drain([&](Item* item) { sum += item->value; });
+      if (n == 0) {
+        fu::cpu_relax();
+      }
+      popped += n;
+    } else {
+      Item* item = q.pop();
+      if (item == nullptr) {
+        fu::cpu_relax();
+        continue;
+      }
+      sum += item->value;
+      popped++;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  if (sum != 0) {
+    std::abort();  // keep the loop from being optimized away
+  }
+
+  std::chrono::duration<double> secs = end - start;
+  return expected / secs.count() / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::size_t total = 4 * 1000 * 1000;
+  if (argc > 1) {
+    total = std::strtoull(argv[1], nullptr, 10);
+  }
+
+  std::printf("million items per second\n");
+  std::printf("%-10s %14s %14s %14s %14s\n", "producers", "lockfree pop",
+              "mpsc pop", "lockfree all", "mpsc drain");
+  for (std::size_t producers : {1, 4, 16}) {
+    double bp = run<BoostQueue, false>(producers, total);
+    double mp = run<IntrusiveQueue, false>(producers, total);
+    double ba = run<BoostQueue, true>(producers, total);
+    double md = run<IntrusiveQueue, true>(producers, total);
+    std::printf("%-10zu %14.2f %14.2f %14.2f %14.2f\n", producers, bp, mp,
+                ba, md);
+  }
+  return 0;
+}
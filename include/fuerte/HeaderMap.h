@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_HEADER_MAP_H
+#define ARANGO_CXX_DRIVER_HEADER_MAP_H 1
+
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fuerte/types.h>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief Compact key-value storage of header meta data and query
+/// parameters. Entries are kept sorted by key in a flat array, the first
+/// `inlineEntries` without any allocation, so iteration yields the same
+/// order as the std::map this replaces, i.e. for query strings. Well-known
+/// header names are stored as HeaderId, so they cost neither memory nor a
+/// string comparison on lookup. Lookups are linear, which beats a tree for
+/// the handful of entries a message typically has.
+class HeaderMap {
+ public:
+  static constexpr std::size_t inlineEntries = 4;
+
+  struct Entry {
+    /// interned name, or `name` for HeaderId::Custom
+    std::string_view key() const {
+      return id == HeaderId::Custom ? std::string_view(name) : headerName(id);
+    }
+
+    HeaderId id = HeaderId::Custom;
+    /// only set for HeaderId::Custom
+    std::string name;
+    std::string value;
+  };
+
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Entry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Entry const*;
+    using reference = Entry const&;
+
+    const_iterator(HeaderMap const* map, std::size_t pos)
+        : _map(map), _pos(pos) {}
+    reference operator*() const { return _map->at(_pos); }
+    pointer operator->() const { return &_map->at(_pos); }
+    const_iterator& operator++() {
+      ++_pos;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator it = *this;
+      ++_pos;
+      return it;
+    }
+    bool operator==(const_iterator const& o) const { return _pos == o._pos; }
+    bool operator!=(const_iterator const& o) const { return _pos != o._pos; }
+
+   private:
+    HeaderMap const* _map;
+    std::size_t _pos;
+  };
+
+  HeaderMap() = default;
+  /// @brief conversion for existing code that builds a StringMap
+  HeaderMap(StringMap const& map) {
+    for (auto const& pair : map) {
+      emplace(pair.first, pair.second);
+    }
+  }
+
+  bool empty() const { return _size == 0; }
+  std::size_t size() const { return _size; }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, _size); }
+
+  /// @brief entry with the given key, nullptr if there is none
+  Entry const* find(std::string_view key) const {
+    std::size_t i = indexOf(toHeaderId(key), key);
+    return i < _size ? &at(i) : nullptr;
+  }
+
+  /// @brief entry of a well-known header, nullptr if there is none
+  Entry const* find(HeaderId id) const {
+    assert(id != HeaderId::Custom);
+    std::size_t i = indexOf(id, std::string_view());
+    return i < _size ? &at(i) : nullptr;
+  }
+
+  /// @brief add an entry unless the key exists already, like
+  /// std::map::emplace
+  template <typename K, typename V>
+  bool emplace(K&& key, V&& value) {
+    return emplace(toHeaderId(key), std::forward<K>(key),
+                   std::forward<V>(value));
+  }
+
+  /// @brief emplace() with the id of `key` known already
+  template <typename K, typename V>
+  bool emplace(HeaderId id, K&& key, V&& value) {
+    if (indexOf(id, key) < _size) {
+      return false;
+    }
+    std::size_t pos = lowerBound(
+        id == HeaderId::Custom ? std::string_view(key) : headerName(id));
+    Entry& e = append();
+    e.id = id;
+    if (id == HeaderId::Custom) {
+      e.name = std::forward<K>(key);
+    }
+    e.value = std::forward<V>(value);
+    for (std::size_t i = _size - 1; i > pos; i--) {
+      std::swap(mutableAt(i), mutableAt(i - 1));
+    }
+    return true;
+  }
+
+  /// @brief add or replace an entry
+  void set(std::string_view key, std::string value) {
+    HeaderId id = toHeaderId(key);
+    std::size_t i = indexOf(id, key);
+    if (i < _size) {
+      mutableAt(i).value = std::move(value);
+    } else {
+      emplace(id, key, std::move(value));
+    }
+  }
+
+  /// @brief remove an entry, the others stay sorted
+  bool erase(std::string_view key) {
+    std::size_t i = indexOf(toHeaderId(key), key);
+    if (i >= _size) {
+      return false;
+    }
+    for (; i + 1 < _size; i++) {
+      std::swap(mutableAt(i), mutableAt(i + 1));
+    }
+    pop();
+    return true;
+  }
+
+  void clear() {
+    while (_size > 0) {
+      pop();
+    }
+  }
+
+ private:
+  /// position of the entry, _size if there is none
+  std::size_t indexOf(HeaderId id, std::string_view name) const {
+    for (std::size_t i = 0; i < _size; i++) {
+      Entry const& e = at(i);
+      if (e.id == id && (id != HeaderId::Custom || e.name == name)) {
+        return i;
+      }
+    }
+    return _size;
+  }
+
+  /// position of the first entry with a key not less than `key`
+  std::size_t lowerBound(std::string_view key) const {
+    std::size_t i = 0;
+    while (i < _size && at(i).key() < key) {
+      i++;
+    }
+    return i;
+  }
+
+  Entry const& at(std::size_t i) const {
+    return i < inlineEntries ? _inline[i] : _overflow[i - inlineEntries];
+  }
+  Entry& mutableAt(std::size_t i) {
+    return i < inlineEntries ? _inline[i] : _overflow[i - inlineEntries];
+  }
+
+  Entry& append() {
+    if (_size < inlineEntries) {
+      return _inline[_size++];
+    }
+    _size++;
+    return _overflow.emplace_back();
+  }
+
+  /// drop the last entry, inline strings keep their capacity
+  void pop() {
+    assert(_size > 0);
+    if (--_size < inlineEntries) {
+      _inline[_size].name.clear();
+      _inline[_size].value.clear();
+    } else {
+      _overflow.pop_back();
+    }
+  }
+
+ private:
+  std::array<Entry, inlineEntries> _inline;
+  std::vector<Entry> _overflow;
+  std::size_t _size = 0;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
@@ -29,9 +29,12 @@
 #include "types.h"
 
 #include <memory>
+#include <new>
 #include <string>
+#include <vector>
 
 namespace arangodb { namespace fuerte { inline namespace v1 {
+
 // Connection is the base class for a connection between a client
 // and a server.
 // Different protocols (HTTP, VST) are implemented in derived classes.
@@ -56,8 +59,13 @@ class Connection : public std::enable_shared_from_this<Connection> {
   };
 
   /// @brief Send a request to the server and wait into a response it received.
+  /// Throws the fuerte::Error if the request failed.
   std::unique_ptr<Response> sendRequest(std::unique_ptr<Request> r);
 
+  /// @brief Send a request to the server and wait for the result, errors
+  /// are returned instead of thrown: sendRequest(std::move(r), std::nothrow)
+  RequestResult sendRequest(std::unique_ptr<Request> r, std::nothrow_t);
+
   /// @brief Send a request to the server and wait into a response it received.
   /// @param r request that is copied
   std::unique_ptr<Response> sendRequest(Request const& r) {
@@ -68,19 +76,47 @@ class Connection : public std::enable_shared_from_this<Connection> {
   /// @brief Send a request to the server and return immediately.
   /// When a response is received or an error occurs, the corresponding
   /// callbackis called. The callback is executed on a specific
-  /// IO-Thread for this connection.
-  virtual MessageID sendRequest(std::unique_ptr<Request> r,
-                                RequestCallback cb) = 0;
+  /// IO-Thread for this connection, or the callback executor if one is
+  /// set. If the request queue is full the callback is invoked with
+  /// Error::QueueCapacityExceeded, the same way.
+  MessageID sendRequest(std::unique_ptr<Request> r, RequestHandler cb);
+
+  /// @brief Send a request to the server if the request queue has space
+  /// left and return immediately. Returns 0 if the queue is full, `r` and
+  /// `cb` are left untouched in this case and may be sent again later,
+  /// see notifyOnQueueSpace().
+  virtual MessageID trySendRequest(std::unique_ptr<Request>& r,
+                                   RequestHandler& cb) = 0;
+
+  /// @brief trySendRequest() for a copyable callback, the connection
+  /// keeps a copy of `cb`
+  MessageID trySendRequest(std::unique_ptr<Request>& r, RequestCallback& cb) {
+    RequestHandler handler(cb);
+    return trySendRequest(r, handler);
+  }
+
+  /// @brief Invoke `cb` once, as soon as the request queue has drained to
+  /// half of its capacity. May be invoked on the calling thread if there
+  /// is space already, otherwise on the IO-Thread of this connection.
+  virtual void notifyOnQueueSpace(std::function<void()> cb) = 0;
 
   /// @brief Send a request to the server and return immediately.
   /// When a response is received or an error occurs, the corresponding
   /// callbackis called. The callback is executed on a specific
   /// IO-Thread for this connection.
-  MessageID sendRequest(Request const& r, RequestCallback cb) {
+  MessageID sendRequest(Request const& r, RequestHandler cb) {
     auto copy = std::make_unique<Request>(r);
-    return sendRequest(std::move(copy), cb);
+    return sendRequest(std::move(copy), std::move(cb));
   }
 
+  /// @brief Cancel a single request, identified by the MessageID returned
+  /// from sendRequest. A queued request is never written, VST forgets an
+  /// in-flight request and discards its response, HTTP abandons the
+  /// response by closing the connection. The request callback is invoked
+  /// with Error::Canceled on the IO-Thread, unless the request has
+  /// finished already.
+  virtual void cancelRequest(MessageID mid) = 0;
+
   /// @brief Return the number of requests that have not yet finished.
   virtual std::size_t requestsLeft() const = 0;
 
@@ -90,6 +126,15 @@ class Connection : public std::enable_shared_from_this<Connection> {
   /// @brief cancel the connection, unusable afterwards
   virtual void cancel() = 0;
 
+  /// @brief bytes of responses the connection is receiving right now,
+  /// counted against ConnectionBuilder::memoryBudget()
+  virtual std::size_t bufferedBytes() const { return 0; }
+
+  /// @brief hand a response back once it is no longer needed, the
+  /// connection reuses its memory for a later response. Optional,
+  /// dropping the response is always fine.
+  virtual void recycle(std::unique_ptr<Response>) {}
+
   /// @brief endpoint we are connected to
   std::string endpoint() const;
 
@@ -99,6 +144,21 @@ class Connection : public std::enable_shared_from_this<Connection> {
   /// @brief Activate the connection.
   virtual void startConnection() = 0;
 
+  /// @brief complete a request that was never queued with `err`. The
+  /// callback runs where all callbacks do: on the IO-Thread or the
+  /// callback executor, never on the thread calling sendRequest.
+  virtual void failRequest(Error err, std::unique_ptr<Request> r,
+                           RequestHandler cb) = 0;
+
+  // Invoke the configured ConnectCallback (if any)
+  void onConnect(Error errorCode) {
+    if (_config._onConnect) {
+      try {
+        _config._onConnect(errorCode);
+      } catch(...) {}
+    }
+  }
+
   // Invoke the configured ConnectionFailureCallback (if any)
   void onFailure(Error errorCode, const std::string& errorMessage) {
     if (_config._onFailure) {
@@ -133,6 +193,14 @@ class ConnectionBuilder {
   // Create an connection and start opening it.
   std::shared_ptr<Connection> connect(EventLoopService& eventLoopService);
 
+  /// @brief open `count` connections ahead of time, so the first requests
+  /// do not pay for connecting, TLS and VST authentication. `done` is
+  /// invoked once every connection is established or has failed, with
+  /// the number of established connections.
+  std::vector<std::shared_ptr<Connection>> prewarm(
+      EventLoopService& eventLoopService, std::size_t count,
+      std::function<void(std::size_t)> done);
+
   /// @brief idle connection timeout (60s default)
   inline std::chrono::milliseconds idleTimeout() const {
     return _conf._idleTimeout;
@@ -143,6 +211,113 @@ class ConnectionBuilder {
     return *this;
   }
 
+  /// @brief how long host name lookups are cached (30s default),
+  /// 0 disables the cache. An entry is dropped early once none of its
+  /// addresses accepts a connection.
+  inline std::chrono::milliseconds resolveCacheTtl() const {
+    return _conf._resolveCacheTtl;
+  }
+  ConnectionBuilder& resolveCacheTtl(std::chrono::milliseconds t) {
+    _conf._resolveCacheTtl = t;
+    return *this;
+  }
+  /// @brief how long failed host name lookups are cached (1s default)
+  inline std::chrono::milliseconds resolveNegativeTtl() const {
+    return _conf._resolveNegativeTtl;
+  }
+  ConnectionBuilder& resolveNegativeTtl(std::chrono::milliseconds t) {
+    _conf._resolveNegativeTtl = t;
+    return *this;
+  }
+  /// @brief delay before a parallel connection attempt to the next resolved
+  /// address is started (250ms default), 0 tries addresses one by one
+  inline std::chrono::milliseconds connectAttemptDelay() const {
+    return _conf._connectAttemptDelay;
+  }
+  ConnectionBuilder& connectAttemptDelay(std::chrono::milliseconds t) {
+    _conf._connectAttemptDelay = t;
+    return *this;
+  }
+
+  /// @brief maximum number of requests waiting to be sent (1024 default).
+  /// trySendRequest refuses requests beyond this bound.
+  inline uint32_t maxQueuedRequests() const {
+    return _conf._maxQueuedRequests;
+  }
+  ConnectionBuilder& maxQueuedRequests(uint32_t n) {
+    _conf._maxQueuedRequests = n;
+    return *this;
+  }
+
+  /// @brief how many queued requests of each priority class (high, normal,
+  /// low) are sent per round before the next class gets a turn (8, 4, 1)
+  inline std::array<uint32_t, numRequestPriorities> priorityWeights() const {
+    return _conf._priorityWeights;
+  }
+  ConnectionBuilder& priorityWeights(uint32_t high, uint32_t normal,
+                                     uint32_t low) {
+    _conf._priorityWeights = {{high, normal, low}};
+    return *this;
+  }
+
+  /// @brief name of a header that tells the server how many seconds are
+  /// left until the request deadline (i.e. "x-arango-queue-time-seconds"),
+  /// so it can drop expired work. Empty (the default) sends nothing.
+  inline std::string deadlineHeader() const { return _conf._deadlineHeader; }
+  ConnectionBuilder& deadlineHeader(std::string const& h) {
+    _conf._deadlineHeader = h;
+    return *this;
+  }
+
+  /// @brief maximum size of a response body in bytes, 0 (the default) is
+  /// unlimited. Larger responses fail with Error::ResponseTooLarge as
+  /// soon as their size is known.
+  inline std::size_t maxResponseSize() const { return _conf._maxResponseSize; }
+  ConnectionBuilder& maxResponseSize(std::size_t n) {
+    _conf._maxResponseSize = n;
+    return *this;
+  }
+
+  /// @brief bytes of responses the connection may buffer at once, 0 (the
+  /// default) is unlimited. A response that does not fit fails with
+  /// Error::MemoryBudgetExceeded, see also LoopOptions::memoryBudget.
+  inline std::size_t memoryBudget() const { return _conf._memoryBudget; }
+  ConnectionBuilder& memoryBudget(std::size_t n) {
+    _conf._memoryBudget = n;
+    return *this;
+  }
+
+  /// @brief io_context of the EventLoopService to run the connection on,
+  /// -1 (the default) picks the least loaded one. Use
+  /// EventLoopService::currentIOContext() to stay on the caller's thread.
+  inline int ioContext() const { return _conf._ioContext; }
+  ConnectionBuilder& ioContext(int index) {
+    _conf._ioContext = index;
+    return *this;
+  }
+
+  /// @brief SO_BUSY_POLL time for the socket (Linux only, 0 disables).
+  /// Pairs well with LoopOptions::busyPollThreads, the kernel may require
+  /// CAP_NET_ADMIN to raise it above net.core.busy_read.
+  inline std::chrono::microseconds socketBusyPoll() const {
+    return _conf._socketBusyPoll;
+  }
+  ConnectionBuilder& socketBusyPoll(std::chrono::microseconds t) {
+    _conf._socketBusyPoll = t;
+    return *this;
+  }
+
+  /// @brief executor for request callbacks, i.e. a WorkStealingPool.
+  /// Null (the default) runs them on the IO thread, where a slow callback
+  /// delays every connection of the same io_context.
+  inline std::shared_ptr<CallbackExecutor> callbackExecutor() const {
+    return _conf._callbackExecutor;
+  }
+  ConnectionBuilder& callbackExecutor(std::shared_ptr<CallbackExecutor> e) {
+    _conf._callbackExecutor = std::move(e);
+    return *this;
+  }
+
   // Set the authentication type of the connection
   inline AuthenticationType authenticationType() const {
     return _conf._authenticationType;
@@ -197,12 +372,55 @@ class ConnectionBuilder {
     return *this;
   }
 
+  /// @brief error rate within the breaker window that opens the endpoint
+  /// circuit breaker, 0 (the default) disables the breaker
+  inline double breakerFailureRatio() const {
+    return _conf._breakerFailureRatio;
+  }
+  ConnectionBuilder& breakerFailureRatio(double r) {
+    _conf._breakerFailureRatio = r;
+    return *this;
+  }
+  /// @brief minimum number of requests in the window before the error
+  /// rate is considered (5 default)
+  inline unsigned breakerMinRequests() const {
+    return _conf._breakerMinRequests;
+  }
+  ConnectionBuilder& breakerMinRequests(unsigned n) {
+    _conf._breakerMinRequests = n;
+    return *this;
+  }
+  /// @brief observation window of the circuit breaker (10s default)
+  inline std::chrono::milliseconds breakerWindow() const {
+    return _conf._breakerWindow;
+  }
+  ConnectionBuilder& breakerWindow(std::chrono::milliseconds t) {
+    _conf._breakerWindow = t;
+    return *this;
+  }
+  /// @brief time an open breaker fails requests before it lets a
+  /// probe request through (5s default)
+  inline std::chrono::milliseconds breakerOpenTimeout() const {
+    return _conf._breakerOpenTimeout;
+  }
+  ConnectionBuilder& breakerOpenTimeout(std::chrono::milliseconds t) {
+    _conf._breakerOpenTimeout = t;
+    return *this;
+  }
+
   // Set a callback for connection failures that are not request specific.
   ConnectionBuilder& onFailure(ConnectionFailureCallback c) {
     _conf._onFailure = c;
     return *this;
   }
 
+  // Set a callback that is invoked whenever a connection attempt finished,
+  // i.e. the connection is ready for requests or connecting failed.
+  ConnectionBuilder& onConnect(ConnectCallback c) {
+    _conf._onConnect = c;
+    return *this;
+  }
+
  private:
   detail::ConnectionConfiguration _conf;
 };
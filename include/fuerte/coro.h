@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_CORO_H
+#define ARANGO_CXX_DRIVER_CORO_H 1
+
+#include <fuerte/connection.h>
+
+#if FUERTE_HAS_COROUTINES
+
+#include <atomic>
+#include <coroutine>
+
+#include <fuerte/executor.h>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief awaitable returned by request(). The coroutine is resumed on the
+/// IO thread of the connection, or on `executor` if one was given, and
+/// receives the RequestResult.
+///
+///   RequestResult res = co_await request(*conn, std::move(req));
+///
+/// The callback handed to the connection only captures the awaitable,
+/// which lives in the coroutine frame, so the RequestHandler stores it in
+/// its inline buffer without allocating.
+class RequestAwaitable {
+ public:
+  RequestAwaitable(Connection& conn, std::unique_ptr<Request> req,
+                   CallbackExecutor* executor)
+      : _connection(conn),
+        _executor(executor),
+        _suspended(false) {
+    _result.request = std::move(req);
+  }
+
+  RequestAwaitable(RequestAwaitable const&) = delete;
+  RequestAwaitable& operator=(RequestAwaitable const&) = delete;
+
+  bool await_ready() const noexcept { return false; }
+
+  bool await_suspend(std::coroutine_handle<> handle) {
+    _handle = handle;
+    _connection.sendRequest(
+        std::move(_result.request),
+        [this](Error e, std::unique_ptr<Request> req,
+               std::unique_ptr<Response> res) {
+          _result.error = e;
+          _result.request = std::move(req);
+          _result.response = std::move(res);
+          // whoever comes second resumes, the callback may run before
+          // sendRequest has returned
+          if (_suspended.exchange(true, std::memory_order_acq_rel)) {
+            resume();
+          }
+        });
+    // false resumes right away, the result is there already
+    return !_suspended.exchange(true, std::memory_order_acq_rel);
+  }
+
+  RequestResult await_resume() { return std::move(_result); }
+
+ private:
+  void resume() {
+    if (_executor != nullptr) {
+      _executor->post([h = _handle] { h.resume(); });
+    } else {
+      _handle.resume();
+    }
+  }
+
+ private:
+  Connection& _connection;
+  CallbackExecutor* _executor;
+  std::coroutine_handle<> _handle;
+  std::atomic<bool> _suspended;
+  RequestResult _result;
+};
+
+/// @brief Send a request and co_await its RequestResult, the coroutine
+/// resumes on the IO-Thread or on `executor`. A free function, so that
+/// Connection looks the same to C++17 and C++20 translation units.
+inline RequestAwaitable request(Connection& conn, std::unique_ptr<Request> r,
+                                CallbackExecutor* executor = nullptr) {
+  return RequestAwaitable(conn, std::move(r), executor);
+}
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
+#endif
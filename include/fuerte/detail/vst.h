@@ -92,7 +92,9 @@ struct Chunk {
 namespace message {
   
 /// @brief creates a slice containing a VST request-message header.
-void requestHeader(RequestHeader const&, velocypack::Buffer<uint8_t>&);
+/// @param extraMeta additional meta fields, i.e. set by the connection
+void requestHeader(RequestHeader const&, velocypack::Buffer<uint8_t>&,
+                   StringMap const* extraMeta = nullptr);
 /// @brief creates a slice containing a VST response-message header.
 void responseHeader(ResponseHeader const&, velocypack::Buffer<uint8_t>&);
 /// @brief creates a slice containing a VST auth message with JWT encryption
@@ -106,11 +108,22 @@ void authBasic(std::string const& username,
 /// @param buffer is containing the metadata. If non-empty this will be used
 ///        as a prefix to the payload.
 /// @param payload the payload that is going to be partitioned
+/// @param chunkStarts if set, receives the index in `result` where each
+///        chunk begins
 void prepareForNetwork(VSTVersion vstVersion,
                        MessageID messageId,
                        velocypack::Buffer<uint8_t>& buffer,
                        asio_ns::const_buffer payload,
-                       std::vector<asio_ns::const_buffer>& result);
+                       std::vector<asio_ns::const_buffer>& result,
+                       std::vector<std::size_t>* chunkStarts = nullptr);
+/// @brief same as above for a payload made of several segments, which are
+///        referenced in place
+void prepareForNetwork(VSTVersion vstVersion,
+                       MessageID messageId,
+                       velocypack::Buffer<uint8_t>& buffer,
+                       std::vector<asio_ns::const_buffer> const& payload,
+                       std::vector<asio_ns::const_buffer>& result,
+                       std::vector<std::size_t>* chunkStarts = nullptr);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_EXECUTOR_H
+#define ARANGO_CXX_DRIVER_EXECUTOR_H 1
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief Runs request callbacks off the IO threads. Set it with
+/// ConnectionBuilder::callbackExecutor(), so that a slow callback does
+/// not stall the other connections of its event loop.
+class CallbackExecutor {
+ public:
+  virtual ~CallbackExecutor() = default;
+
+  /// @brief run `task` soon on some thread, must not block the caller
+  virtual void post(std::function<void()> task) = 0;
+};
+
+/// @brief Thread pool with one task deque per worker. Tasks posted by a
+/// worker go to its own deque and are taken LIFO, tasks posted from
+/// outside are spread round-robin. Idle workers steal the oldest task
+/// from the other deques before they go to sleep.
+///
+/// Pending tasks are still run on destruction.
+class WorkStealingPool final : public CallbackExecutor {
+ public:
+  explicit WorkStealingPool(unsigned threadCount = 2);
+  ~WorkStealingPool();
+
+  WorkStealingPool(WorkStealingPool const&) = delete;
+  WorkStealingPool& operator=(WorkStealingPool const&) = delete;
+
+  void post(std::function<void()> task) override;
+
+ private:
+  /// state shared with the threads, a pool may be destroyed by the last
+  /// reference held in one of its own callbacks
+  struct Shared;
+  std::shared_ptr<Shared> _shared;
+  std::vector<std::thread> _threads;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
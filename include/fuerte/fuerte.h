@@ -24,6 +24,9 @@
 #define ARANGO_CXX_DRIVER_ARANGOC
 
 #include "connection.h"
+#include "coro.h"
+#include "executor.h"
+#include "future.h"
 #include "helper.h"
 #include "loop.h"
 #include "requests.h"
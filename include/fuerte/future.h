@@ -0,0 +1,300 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_FUTURE_H
+#define ARANGO_CXX_DRIVER_FUTURE_H 1
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "connection.h"
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief value of a Future<void>-like continuation
+struct Unit {};
+
+namespace detail {
+/// @brief state shared by one Promise and one Future. Value and
+/// continuation meet through a single compare-and-swap, whichever
+/// arrives second runs the continuation, no mutex involved.
+template <typename T>
+class FutureState {
+ public:
+  FutureState() : _refs(1), _state(Start) {}
+
+  void addRef() { _refs.fetch_add(1, std::memory_order_relaxed); }
+
+  void setValue(T&& value) {
+    _value.emplace(std::move(value));
+    uint8_t expected = Start;
+    if (!_state.compare_exchange_strong(expected, HasValue,
+                                        std::memory_order_acq_rel)) {
+      assert(expected == HasCallback);
+      _state.store(Done, std::memory_order_relaxed);
+      _callback(std::move(*_value));
+    }
+  }
+
+  void setCallback(unique_function<void(T&&)> cb) {
+    _callback = std::move(cb);
+    uint8_t expected = Start;
+    if (!_state.compare_exchange_strong(expected, HasCallback,
+                                        std::memory_order_acq_rel)) {
+      assert(expected == HasValue);
+      _state.store(Done, std::memory_order_relaxed);
+      _callback(std::move(*_value));
+    }
+  }
+
+  /// @brief true once the value is set, whether or not a continuation
+  /// has consumed it already
+  bool hasValue() const {
+    uint8_t state = _state.load(std::memory_order_acquire);
+    return state == HasValue || state == Done;
+  }
+
+  void release() {
+    if (_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+ private:
+  enum : uint8_t { Start, HasValue, HasCallback, Done };
+
+  std::atomic<uint32_t> _refs;
+  std::atomic<uint8_t> _state;
+  std::optional<T> _value;
+  unique_function<void(T&&)> _callback;
+};
+}  // namespace detail
+
+template <typename T>
+class Future;
+
+/// @brief write side of a Future, fulfil it exactly once with setValue().
+/// Copies refer to the same shared state.
+template <typename T>
+class Promise {
+ public:
+  Promise() : _state(new detail::FutureState<T>()) {}
+  Promise(Promise const& other) : _state(other._state) { _state->addRef(); }
+  Promise(Promise&& other) noexcept : _state(other._state) {
+    other._state = nullptr;
+  }
+  Promise& operator=(Promise const&) = delete;
+  Promise& operator=(Promise&&) = delete;
+  ~Promise() {
+    if (_state != nullptr) {
+      _state->release();
+    }
+  }
+
+  /// @brief the one Future of this promise, call at most once
+  Future<T> getFuture();
+
+  void setValue(T value) const { _state->setValue(std::move(value)); }
+
+ private:
+  detail::FutureState<T>* _state;
+};
+
+/// @brief Lightweight future: one shared state allocation, value and
+/// continuation are exchanged without locks. Continuations run on the
+/// thread that fulfils the promise, for requests that is the IO thread
+/// (or the configured callback executor). They must not throw.
+template <typename T>
+class Future {
+ public:
+  Future() : _state(nullptr) {}
+  Future(Future&& other) noexcept : _state(other._state) {
+    other._state = nullptr;
+  }
+  Future& operator=(Future&& other) noexcept {
+    if (this != &other) {
+      reset();
+      _state = other._state;
+      other._state = nullptr;
+    }
+    return *this;
+  }
+  Future(Future const&) = delete;
+  Future& operator=(Future const&) = delete;
+  ~Future() { reset(); }
+
+  bool valid() const { return _state != nullptr; }
+
+  /// @brief true if the value is available
+  bool isReady() const { return _state != nullptr && _state->hasValue(); }
+
+  /// @brief run `f` with the value once it is available. Consumes the
+  /// future, returns a future for the result of `f` (Unit for void).
+  template <typename F, typename R = std::invoke_result_t<F, T&&>>
+  auto then(F&& f) -> Future<std::conditional_t<std::is_void_v<R>, Unit, R>> {
+    using Next = std::conditional_t<std::is_void_v<R>, Unit, R>;
+    assert(valid());
+    Promise<Next> promise;
+    Future<Next> next = promise.getFuture();
+    _state->setCallback([promise = std::move(promise),
+                         f = std::forward<F>(f)](T&& value) mutable {
+      if constexpr (std::is_void_v<R>) {
+        f(std::move(value));
+        promise.setValue(Unit{});
+      } else {
+        promise.setValue(f(std::move(value)));
+      }
+    });
+    reset();
+    return next;
+  }
+
+ private:
+  friend class Promise<T>;
+
+  explicit Future(detail::FutureState<T>* s) : _state(s) {}
+
+  void reset() {
+    if (_state != nullptr) {
+      _state->release();
+      _state = nullptr;
+    }
+  }
+
+  detail::FutureState<T>* _state;
+};
+
+template <typename T>
+Future<T> Promise<T>::getFuture() {
+  _state->addRef();
+  return Future<T>(_state);
+}
+
+/// @brief future of all values, in the order of `futures`
+template <typename T>
+Future<std::vector<T>> whenAll(std::vector<Future<T>> futures) {
+  struct Context {
+    std::vector<T> values;
+    std::atomic<std::size_t> pending;
+    Promise<std::vector<T>> promise;
+  };
+  auto ctx = std::make_shared<Context>();
+  Future<std::vector<T>> result = ctx->promise.getFuture();
+  if (futures.empty()) {
+    ctx->promise.setValue({});
+    return result;
+  }
+  ctx->values.resize(futures.size());
+  ctx->pending.store(futures.size(), std::memory_order_relaxed);
+  for (std::size_t i = 0; i < futures.size(); i++) {
+    futures[i].then([ctx, i](T&& value) {
+      ctx->values[i] = std::move(value);
+      if (ctx->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        ctx->promise.setValue(std::move(ctx->values));
+      }
+    });
+  }
+  return result;
+}
+
+/// @brief future of the first available value and its index
+template <typename T>
+Future<std::pair<std::size_t, T>> whenAny(std::vector<Future<T>> futures) {
+  assert(!futures.empty());
+  struct Context {
+    std::atomic<bool> done{false};
+    Promise<std::pair<std::size_t, T>> promise;
+  };
+  auto ctx = std::make_shared<Context>();
+  Future<std::pair<std::size_t, T>> result = ctx->promise.getFuture();
+  for (std::size_t i = 0; i < futures.size(); i++) {
+    futures[i].then([ctx, i](T&& value) {
+      if (!ctx->done.exchange(true, std::memory_order_acq_rel)) {
+        ctx->promise.setValue(std::make_pair(i, std::move(value)));
+      }
+    });
+  }
+  return result;
+}
+
+namespace detail {
+/// @brief promise captured by a request callback. If the callback is
+/// destroyed without ever being invoked the future still completes, with
+/// Error::Canceled.
+class RequestPromise {
+ public:
+  RequestPromise() = default;
+  RequestPromise(RequestPromise&& other) noexcept
+      : _promise(std::move(other._promise)) {
+    other._promise.reset();
+  }
+  RequestPromise& operator=(RequestPromise&&) = delete;
+  ~RequestPromise() {
+    if (_promise) {
+      RequestResult result;
+      result.error = Error::Canceled;
+      _promise->setValue(std::move(result));
+    }
+  }
+
+  Future<RequestResult> getFuture() { return _promise->getFuture(); }
+
+  void setValue(RequestResult result) {
+    _promise->setValue(std::move(result));
+    _promise.reset();
+  }
+
+ private:
+  std::optional<Promise<RequestResult>> _promise{std::in_place};
+};
+}  // namespace detail
+
+/// @brief tag for sendRequest() returning a Future
+struct UseFuture {};
+constexpr UseFuture useFuture{};
+
+/// @brief Send a request to the server and return a Future of its
+/// result, i.e. sendRequest(conn, std::move(req), useFuture). The future
+/// is fulfilled on the IO-Thread.
+inline Future<RequestResult> sendRequest(Connection& conn,
+                                         std::unique_ptr<Request> r,
+                                         UseFuture) {
+  detail::RequestPromise promise;
+  Future<RequestResult> future = promise.getFuture();
+  conn.sendRequest(std::move(r), [promise = std::move(promise)](
+                                     Error e, std::unique_ptr<Request> req,
+                                     std::unique_ptr<Response> res) mutable {
+    RequestResult result;
+    result.error = e;
+    result.request = std::move(req);
+    result.response = std::move(res);
+    promise.setValue(std::move(result));
+  });
+  return future;
+}
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
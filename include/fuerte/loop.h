@@ -25,11 +25,17 @@
 #ifndef ARANGO_CXX_DRIVER_SERVER
 #define ARANGO_CXX_DRIVER_SERVER
 
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <fuerte/asio_ns.h>
+#include <fuerte/types.h>
 
 // run / runWithWork / poll for Loop mapping to ioservice
 // free function run with threads / with thread group barrier and work
@@ -38,41 +44,184 @@ namespace arangodb { namespace fuerte { inline namespace v1 {
 
 // need partial rewrite so it can be better integrated in client applications
 
+class CircuitBreaker;
+struct ObjectPools;
+class ResolverCache;
+class TlsSessionCache;
+
 typedef asio_ns::executor_work_guard<asio_ns::io_context::executor_type>
     asio_work_guard;
 
+/// @brief options of an EventLoopService
+struct LoopOptions {
+  /// number of io_contexts, each one runs on its own thread
+  unsigned threadCount = 1;
+  /// if not empty, thread i is pinned to cpu cpuAffinity[i % size]
+  std::vector<unsigned> cpuAffinity;
+  /// the first `busyPollThreads` threads spin on io_context::poll()
+  /// instead of blocking in epoll, trading a cpu core for lower latency
+  unsigned busyPollThreads = 0;
+  /// how long a busy polling thread spins without finding work before
+  /// it blocks until the next event
+  std::chrono::microseconds spinBudget{50};
+  /// bytes of responses all connections may buffer at once, 0 is
+  /// unlimited. Responses beyond it fail with Error::MemoryBudgetExceeded,
+  /// so one runaway query cannot take the memory of the whole process.
+  std::size_t memoryBudget = 0;
+};
+
 /// @brief EventLoopService implements single-threaded event loops
 /// Idea is to shard connections across io context's to avoid
 /// unnecessary synchronization overhead. Please note that on
 /// linux epoll has max 64 instances, so there is a limit on the
 /// number of io_context instances.
+///
+/// New connections go to the io_context with the least load, that is
+/// the number of live connections plus the requests queued on them.
+///
+/// All io_contexts use the reactor asio was built with, epoll on linux
+/// or io_uring with the FUERTE_IO_URING build option. asio picks its
+/// reactor at compile time, the fallback to epoll happens when cmake
+/// finds io_uring unusable on the build host, see backend().
 class EventLoopService {
  public:
   // Initialize an EventLoopService with a given number of threads
-  //  and a given number of io_context
-  explicit EventLoopService(unsigned int threadCount = 1);
+  //  and a given number of io_context. If `cpuAffinity` is not empty,
+  //  thread i is pinned to cpu cpuAffinity[i % cpuAffinity.size()]
+  explicit EventLoopService(unsigned int threadCount = 1,
+                            std::vector<unsigned> const& cpuAffinity = {});
+  explicit EventLoopService(LoopOptions const& options);
   virtual ~EventLoopService();
 
   // Prevent copying
   EventLoopService(EventLoopService const& other) = delete;
   EventLoopService& operator=(EventLoopService const& other) = delete;
 
-  // io_service returns a reference to the boost io_service.
+  // io_service returns a reference to the least loaded boost io_service.
   std::shared_ptr<asio_ns::io_context>& nextIOContext() {
-    return _ioContexts[_lastUsed.fetch_add(1, std::memory_order_relaxed) % _ioContexts.size()];
+    return _ioContexts[leastLoaded()];
   }
-  
+
+  /// @brief name of the asio backend, "io_uring" if fuerte was built
+  /// with FUERTE_IO_URING and the build host kernel supported it, else
+  /// the platform default ("epoll" on Linux)
+  static char const* backend();
+
+  /// @brief number of io_contexts (and threads)
+  std::size_t numIOContexts() const { return _ioContexts.size(); }
+
+  /// @brief io_context with the given index
+  std::shared_ptr<asio_ns::io_context>& ioContext(std::size_t index) {
+    return _ioContexts[index % _ioContexts.size()];
+  }
+
+  /// @brief index of the io_context run by the calling thread, -1 if it
+  /// is not one of our threads. Pass it to ConnectionBuilder::ioContext()
+  /// to place a connection on the thread of its caller.
+  int currentIOContext() const;
+
+  /// @brief pick an io_context for a new connection and account for it.
+  /// A hint >= 0 selects a specific io_context, -1 the least loaded one.
+  /// @return index of the io_context, call releaseIOContext() with it
+  std::size_t acquireIOContext(int hint = -1);
+
+  /// @brief a connection on the io_context went away
+  void releaseIOContext(std::size_t index) {
+    _load[index].connections.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /// @brief account for requests queued on connections of an io_context
+  void addQueued(std::size_t index, int32_t delta) {
+    _load[index].queued.fetch_add(static_cast<uint32_t>(delta),
+                                  std::memory_order_relaxed);
+  }
+
+  /// @brief current load of an io_context, connections plus queued requests
+  uint32_t load(std::size_t index) const {
+    return _load[index].connections.load(std::memory_order_relaxed) +
+           _load[index].queued.load(std::memory_order_relaxed);
+  }
+
+  /// @brief account for `n` more response bytes buffered by a
+  /// connection, false if that exceeds LoopOptions::memoryBudget
+  bool chargeMemory(std::size_t n) {
+    std::size_t current = _bufferedBytes.load(std::memory_order_relaxed);
+    do {
+      if (_memoryBudget > 0 && current + n > _memoryBudget) {
+        return false;
+      }
+    } while (!_bufferedBytes.compare_exchange_weak(
+        current, current + n, std::memory_order_relaxed));
+    return true;
+  }
+
+  /// @brief buffered response bytes were handed out or dropped
+  void releaseMemory(std::size_t n) {
+    _bufferedBytes.fetch_sub(n, std::memory_order_relaxed);
+  }
+
+  /// @brief response bytes buffered by all connections right now
+  std::size_t bufferedBytes() const {
+    return _bufferedBytes.load(std::memory_order_relaxed);
+  }
+
+  /// @brief recycled request items and responses of the connections on
+  /// the given io_context
+  ObjectPools& objectPools(std::size_t index);
+
   asio_ns::ssl::context& sslContext();
 
+  /// @brief TLS sessions of recent connections, for session resumption
+  TlsSessionCache& tlsSessionCache() { return *_tlsSessionCache; }
+
+  /// @brief cache for host name lookups, shared by all connections
+  ResolverCache& resolverCache() { return *_resolverCache; }
+
+  /// @brief circuit breaker shared by all connections to the endpoint
+  /// that use the same breaker settings, created on first use
+  std::shared_ptr<CircuitBreaker> circuitBreaker(
+      std::string const& endpoint, detail::ConnectionConfiguration const&);
+
+ private:
+  /// index of the io_context with the least load, round-robin on ties
+  std::size_t leastLoaded();
+
+  /// load counters of one io_context, each on its own cache line
+  struct alignas(64) ContextLoad {
+    std::atomic<uint32_t> connections{0};
+    std::atomic<uint32_t> queued{0};
+  };
+
  private:
-  /// number of last used io_context
+  /// number of last used io_context, rotates the start of the search
   std::atomic<uint32_t> _lastUsed;
+  /// load of each io_context
+  std::unique_ptr<ContextLoad[]> _load;
+
+  /// budget for buffered response bytes, 0 is unlimited
+  std::size_t const _memoryBudget;
+  /// response bytes buffered by all connections
+  std::atomic<std::size_t> _bufferedBytes;
   
   /// protect ssl context creation
   std::mutex _sslContextMutex;
+  /// resumable TLS sessions, must outlive the ssl context
+  std::unique_ptr<TlsSessionCache> _tlsSessionCache;
   /// global SSL context to use here
   std::unique_ptr<asio_ns::ssl::context> _sslContext;
 
+  /// cached host name lookups
+  std::unique_ptr<ResolverCache> _resolverCache;
+
+  /// protect circuit breaker creation
+  std::mutex _breakerMutex;
+  /// circuit breakers by endpoint and breaker settings
+  std::unordered_map<std::string, std::shared_ptr<CircuitBreaker>> _breakers;
+
+  /// object pools of each io_context, handlers pending in an io_context
+  /// may still own pooled objects, so destroy them after the contexts
+  std::unique_ptr<ObjectPools[]> _pools;
+
   /// io contexts
   std::vector<std::shared_ptr<asio_ns::io_context>> _ioContexts;
   /// Threads powering each io_context
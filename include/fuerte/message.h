@@ -25,9 +25,12 @@
 #ifndef ARANGO_CXX_DRIVER_MESSAGE
 #define ARANGO_CXX_DRIVER_MESSAGE
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <fuerte/HeaderMap.h>
 #include <fuerte/asio_ns.h>
 #include <fuerte/types.h>
 
@@ -51,22 +54,23 @@ struct MessageHeader {
   // Header metadata helpers#
   template<typename K, typename V>
   void addMeta(K&& key, V&& value) {
-    if (fu_accept_key == key) {
+    HeaderId id = toHeaderId(key);
+    if (id == HeaderId::Accept) {
       _acceptType = to_ContentType(value);
       if (_acceptType != ContentType::Custom) {
         return;
       }
-    } else if (fu_content_type_key == key) {
+    } else if (id == HeaderId::ContentType) {
       _contentType = to_ContentType(value);
       if (_contentType != ContentType::Custom) {
         return;
       }
     }
-    this->_meta.emplace(std::forward<K>(key), std::forward<V>(value));
+    this->_meta.emplace(id, std::forward<K>(key), std::forward<V>(value));
   }
 
   void setMeta(StringMap);
-  StringMap const& meta() const { return _meta; }
+  HeaderMap const& meta() const { return _meta; }
 
   // Get value for header metadata key, returns empty string if not found.
   std::string const& metaByKey(std::string const& key) const {
@@ -85,7 +89,7 @@ struct MessageHeader {
   }
 
  protected:
-  StringMap _meta;  /// Header meta data (equivalent to HTTP headers)
+  HeaderMap _meta;  /// Header meta data (equivalent to HTTP headers)
   short _version;
   ContentType _contentType = ContentType::Unset;
   ContentType _acceptType = ContentType::Unset;
@@ -99,7 +103,7 @@ struct RequestHeader final : public MessageHeader {
   std::string path;
 
   /// Query parameters
-  StringMap parameters;
+  HeaderMap parameters;
 
   /// HTTP method
   RestVerb restVerb = RestVerb::Illegal;
@@ -174,6 +178,78 @@ class Message {
   bool isContentTypeText() const;
 };
 
+/// @brief Read-only view into a payload buffer that shares ownership of
+/// the whole buffer, see Response::sharePayload() and
+/// Request::addSegment(). Copies and subslices never copy bytes, the
+/// buffer lives as long as any view.
+class PayloadSlice {
+ public:
+  PayloadSlice() : _data(nullptr), _size(0) {}
+  /// @brief view of bytes kept alive by `owner`, i.e. storage of a
+  /// PayloadAllocator
+  PayloadSlice(std::shared_ptr<void const> owner, uint8_t const* data,
+               std::size_t size)
+      : _owner(std::move(owner)), _data(data), _size(size) {}
+  /// @brief view of the whole buffer
+  explicit PayloadSlice(std::shared_ptr<velocypack::Buffer<uint8_t>> owner)
+      : _data(owner->data()), _size(owner->byteSize()) {
+    _owner = std::move(owner);
+  }
+  PayloadSlice(std::shared_ptr<velocypack::Buffer<uint8_t>> owner,
+               std::size_t offset, std::size_t size)
+      : _data(owner->data() + offset), _size(size) {
+    _owner = std::move(owner);
+  }
+
+  uint8_t const* data() const { return _data; }
+  std::size_t size() const { return _size; }
+  bool empty() const { return _size == 0; }
+  asio_ns::const_buffer buffer() const {
+    return asio_ns::const_buffer(_data, _size);
+  }
+
+  /// @brief first velocypack value of the view
+  velocypack::Slice slice() const {
+    return _size > 0 ? velocypack::Slice(_data)
+                     : velocypack::Slice::noneSlice();
+  }
+
+  /// @brief part of this view, sharing the same buffer
+  PayloadSlice subslice(std::size_t offset, std::size_t size) const {
+    PayloadSlice s(*this);
+    s._data += std::min(offset, _size);
+    s._size = std::min(size, _size - std::min(offset, _size));
+    return s;
+  }
+
+  /// @brief the bytes as a shared_ptr (aliasing the buffer), for APIs
+  /// that want to keep them alive on their own
+  std::shared_ptr<uint8_t const> share() const {
+    return std::shared_ptr<uint8_t const>(_owner, _data);
+  }
+
+ private:
+  std::shared_ptr<void const> _owner;
+  uint8_t const* _data;
+  std::size_t _size;
+};
+
+/// @brief Provides the storage of response bodies, set per request with
+/// Request::responseAllocator(). I.e. an arena for a batch of requests
+/// that is freed at once, a pool of huge pages or a preallocated buffer.
+/// Called on the IO thread of the connection, so it has to be thread-safe
+/// if shared between connections.
+class PayloadAllocator {
+ public:
+  virtual ~PayloadAllocator() = default;
+  /// @brief storage for a body of `size` bytes, nullptr to leave the body
+  /// in a default velocypack buffer
+  virtual uint8_t* allocate(std::size_t size) = 0;
+  /// @brief give back storage of allocate(), called once the response
+  /// and all PayloadSlices of it are gone. May be a no-op for arenas.
+  virtual void deallocate(uint8_t* data, std::size_t size) noexcept = 0;
+};
+
 // Request contains the message send to a server in a request.
 class Request final : public Message {
  public:
@@ -181,7 +257,10 @@ class Request final : public Message {
       std::chrono::milliseconds(300 * 1000);
 
   Request(RequestHeader messageHeader = RequestHeader())
-      : header(std::move(messageHeader)), _timeout(defaultTimeout) {}
+      : header(std::move(messageHeader)),
+        _timeout(defaultTimeout),
+        _deadline(std::chrono::steady_clock::time_point::max()),
+        _priority(RequestPriority::Normal) {}
 
   /// @brief request header
   RequestHeader header;
@@ -203,6 +282,11 @@ class Request final : public Message {
   void addVPack(velocypack::Buffer<uint8_t> const& buffer);
   void addVPack(velocypack::Buffer<uint8_t>&& buffer);
   void addBinary(uint8_t const* data, std::size_t length);
+  /// @brief append a shared buffer without copying it, i.e. to send the
+  /// same body to several endpoints or to assemble it from fragments.
+  /// The bytes must not change while a request refers to them. Copies of
+  /// the request share the segments.
+  void addSegment(PayloadSlice segment);
 
   ///////////////////////////////////////////////
   // get payload
@@ -211,17 +295,67 @@ class Request final : public Message {
   /// @brief get velocypack slices contained in request
   /// only valid iff the data was added via addVPack
   std::vector<velocypack::Slice> slices() const override;
+  /// @brief contiguous payload. With segments they are copied into one
+  /// buffer on first use, prefer payloadBuffers() then. Safe to call from
+  /// several threads, but not concurrently with adding payload.
   asio_ns::const_buffer payload() const override;
   std::size_t payloadSize() const override;
+  /// @brief append the pieces of the payload to `out`, for vectored
+  /// writes
+  void payloadBuffers(std::vector<asio_ns::const_buffer>& out) const;
 
-  // get timeout, 0 means no timeout
+  // get timeout, 0 means no timeout. It is counted from the moment the
+  // request is handed to the connection and covers queueing, connecting,
+  // writing and reading.
   inline std::chrono::milliseconds timeout() const { return _timeout; }
   // set timeout
   void timeout(std::chrono::milliseconds timeout) { _timeout = timeout; }
 
+  // get absolute deadline, time_point::max() if not set
+  inline std::chrono::steady_clock::time_point deadline() const {
+    return _deadline;
+  }
+  // set absolute deadline, the earlier of deadline and timeout applies
+  void deadline(std::chrono::steady_clock::time_point d) { _deadline = d; }
+
+  // get priority class, Normal by default
+  inline RequestPriority priority() const { return _priority; }
+  // set priority class
+  void priority(RequestPriority p) { _priority = p; }
+
+  // get allocator for the response body, null for the default heap
+  inline std::shared_ptr<PayloadAllocator> const& responseAllocator() const {
+    return _responseAllocator;
+  }
+  // set allocator for the response body, bodies of unknown length are
+  // received as usual and moved to its storage once complete
+  void responseAllocator(std::shared_ptr<PayloadAllocator> a) {
+    _responseAllocator = std::move(a);
+  }
+
  private:
+  /// payload bytes owned by the request, sent before the segments
   velocypack::Buffer<uint8_t> _payload;
+  /// shared parts of the payload
+  std::vector<PayloadSlice> _segments;
+  /// _payload and _segments in one block, built by payload() if needed.
+  /// Const readers only access it with the std::atomic_* shared_ptr
+  /// functions, copies of the request included.
+  struct FlatPayload {
+    FlatPayload() = default;
+    FlatPayload(FlatPayload const& other)
+        : buffer(std::atomic_load(&other.buffer)) {}
+    FlatPayload& operator=(FlatPayload const& other) {
+      buffer = std::atomic_load(&other.buffer);
+      return *this;
+    }
+    std::shared_ptr<velocypack::Buffer<uint8_t>> buffer;
+  };
+  mutable FlatPayload _flat;
   std::chrono::milliseconds _timeout;
+  std::chrono::steady_clock::time_point _deadline;
+  RequestPriority _priority;
+  std::shared_ptr<PayloadAllocator> _responseAllocator;
 };
 
 // Response contains the message resulting from a request to a server.
@@ -273,17 +407,75 @@ class Response : public Message {
   asio_ns::const_buffer payload() const override;
   std::size_t payloadSize() const override;
   std::shared_ptr<velocypack::Buffer<uint8_t>> copyPayload() const;
+  /// @brief take the payload out of the response, the bytes are moved to
+  /// the front of the buffer if it has a prefix (i.e. the VST header).
+  /// Copies if the payload is shared or in storage of a PayloadAllocator.
   std::shared_ptr<velocypack::Buffer<uint8_t>> stealPayload();
 
+  /// @brief the payload as a refcounted view, no bytes are copied. The
+  /// response keeps using the same, now shared, buffer.
+  PayloadSlice sharePayload();
+
   /// @brief move in the payload
   void setPayload(velocypack::Buffer<uint8_t>&& buffer, std::size_t offset) {
     _payloadOffset = offset;
     _payload = std::move(buffer);
+    _sharedPayload.reset();
+    _allocated = PayloadSlice();
+  }
+
+  /// @brief use bytes kept alive elsewhere as payload, i.e. storage of a
+  /// PayloadAllocator
+  void setPayload(PayloadSlice payload) {
+    setPayload(velocypack::Buffer<uint8_t>(), 0);
+    _allocated = std::move(payload);
+  }
+
+  /// @brief move in the payload, `buffer` gets the storage of the previous
+  /// one back, empty but with its capacity, to receive the next payload
+  void swapPayload(velocypack::Buffer<uint8_t>& buffer, std::size_t offset) {
+    std::swap(_payload, buffer);
+    buffer.reset();
+    _payloadOffset = offset;
+    _sharedPayload.reset();
+    _allocated = PayloadSlice();
+  }
+
+  /// @brief drop the payload, the buffer keeps its capacity for
+  /// swapPayload() if that is at most `keepCapacity`
+  void clearPayload(std::size_t keepCapacity) {
+    if (_payload.capacity() > keepCapacity) {
+      setPayload(velocypack::Buffer<uint8_t>(), 0);
+      return;
+    }
+    _payload.reset();
+    _payloadOffset = 0;
+    _sharedPayload.reset();
+    _allocated = PayloadSlice();
+  }
+
+ private:
+  /// the received buffer, shared or not
+  velocypack::Buffer<uint8_t> const& buffer() const {
+    return _sharedPayload ? *_sharedPayload : _payload;
   }
 
  private:
   velocypack::Buffer<uint8_t> _payload;
+  /// the payload once sharePayload() was called, _payload is empty then
+  std::shared_ptr<velocypack::Buffer<uint8_t>> _sharedPayload;
+  /// payload in storage of a PayloadAllocator, takes precedence
+  PayloadSlice _allocated;
   std::size_t _payloadOffset;
 };
+
+/// @brief outcome of a request, as passed to a RequestHandler
+struct RequestResult {
+  Error error = Error::NoError;
+  std::unique_ptr<Request> request;
+  std::unique_ptr<Response> response;
+
+  bool ok() const { return error == Error::NoError; }
+};
 }}}  // namespace arangodb::fuerte::v1
 #endif
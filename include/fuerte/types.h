@@ -24,14 +24,29 @@
 #ifndef ARANGO_CXX_DRIVER_FUERTE_TYPES
 #define ARANGO_CXX_DRIVER_FUERTE_TYPES
 
+#include <array>
 #include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include <fuerte/unique_function.h>
+
+// co_await support for C++20 users, the library itself is C++17
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define FUERTE_HAS_COROUTINES 1
+#endif
+#endif
+#ifndef FUERTE_HAS_COROUTINES
+#define FUERTE_HAS_COROUTINES 0
+#endif
+
 namespace arangodb { namespace fuerte { inline namespace v1 {
+class CallbackExecutor;
 class Request;
 class Response;
 
@@ -67,11 +82,14 @@ enum class Error : uint16_t {
   ConnectionClosed = 1002,
   Timeout = 1003,
   QueueCapacityExceeded = 1004,
+  CircuitOpen = 1005,
 
   ReadError = 1102,
   WriteError = 1103,
 
   Canceled = 1104,
+  ResponseTooLarge = 1105,       // over ConnectionBuilder::maxResponseSize
+  MemoryBudgetExceeded = 1106,   // connection or EventLoopService budget
   
   VstUnauthorized = 2000,
 
@@ -79,9 +97,14 @@ enum class Error : uint16_t {
 };
 std::string to_string(Error error);
 
-// RequestCallback is called for finished connection requests.
+// RequestHandler is called for finished connection requests.
 // If the given Error is zero, the request succeeded, otherwise an error
-// occurred.
+// occurred. Move-only, lambdas with small captures are stored without
+// allocating.
+using RequestHandler = unique_function<void(Error, std::unique_ptr<Request>,
+                                            std::unique_ptr<Response>)>;
+// RequestCallback is the copyable form of a RequestHandler, kept for
+// existing code. It converts implicitly, copying it may allocate.
 using RequestCallback = std::function<void(Error, std::unique_ptr<Request>,
                                            std::unique_ptr<Response>)>;
 // ConnectionFailureCallback is called when a connection encounters a failure
@@ -92,6 +115,10 @@ using RequestCallback = std::function<void(Error, std::unique_ptr<Request>,
 // - Connection lost
 using ConnectionFailureCallback =
     std::function<void(Error errorCode, const std::string& errorMessage)>;
+// ConnectCallback is called when a connection attempt has finished.
+// The given Error is NoError once the connection is established (and
+// authenticated for VST), otherwise the attempt failed.
+using ConnectCallback = std::function<void(Error errorCode)>;
 
 using StringMap = std::map<std::string, std::string>;
 
@@ -149,6 +176,38 @@ enum class ContentType : uint8_t { Unset = 0, Custom, VPack, Dump, Json, Html, T
 ContentType to_ContentType(std::string const& val);
 std::string to_string(ContentType type);
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                          HeaderId
+// -----------------------------------------------------------------------------
+
+/// @brief interned names of well-known header fields
+enum class HeaderId : uint8_t {
+  Custom = 0,
+  Accept,
+  Authorization,
+  Connection,
+  ContentEncoding,
+  ContentLength,
+  ContentType,
+  Etag,
+  KeepAlive,
+  Location,
+  Server,
+  TransferEncoding,
+  WwwAuthenticate,
+  XArangoAsyncId,
+  XArangoEndpoint,
+  XArangoErrors,
+  XArangoQueueTimeSeconds,
+  XArangoTrxId,
+  XArangoVersion
+};
+/// @brief id of a lower case header name, HeaderId::Custom if it is not
+/// well-known. Case-sensitive, like the keys of the header meta data.
+HeaderId toHeaderId(std::string_view name);
+/// @brief lower case name of a well-known header, empty for Custom
+std::string_view headerName(HeaderId id);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                AuthenticationType
 // -----------------------------------------------------------------------------
@@ -156,6 +215,15 @@ std::string to_string(ContentType type);
 enum class AuthenticationType { None, Basic, Jwt };
 std::string to_string(AuthenticationType type);
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   RequestPriority
+// -----------------------------------------------------------------------------
+
+/// @brief requests of a higher priority class are sent before queued
+/// requests of lower classes, see ConnectionBuilder::priorityWeights
+enum class RequestPriority : uint8_t { High = 0, Normal = 1, Low = 2 };
+constexpr std::size_t numRequestPriorities = 3;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                      Velocystream
 // -----------------------------------------------------------------------------
@@ -180,13 +248,28 @@ struct ConnectionConfiguration {
         _verifyHost(false),
         _connectTimeout(10000),
         _idleTimeout(300000),
+        _resolveCacheTtl(30000),
+        _resolveNegativeTtl(1000),
+        _connectAttemptDelay(250),
         _maxConnectRetries(3),
+        _maxQueuedRequests(1024),
+        _priorityWeights{{8, 4, 1}},
+        _deadlineHeader(),
+        _maxResponseSize(0),
+        _memoryBudget(0),
+        _ioContext(-1),
+        _socketBusyPoll(0),
+        _breakerFailureRatio(0.0),
+        _breakerMinRequests(5),
+        _breakerWindow(10000),
+        _breakerOpenTimeout(5000),
         _authenticationType(AuthenticationType::None),
         _user(""),
         _password(""),
         _jwtToken("") {}
 
   ConnectionFailureCallback _onFailure;
+  ConnectCallback _onConnect;
   SocketType _socketType;      // tcp, ssl or unix
   ProtocolType _protocolType;  // vst or http
   vst::VSTVersion _vstVersion;
@@ -197,7 +280,27 @@ struct ConnectionConfiguration {
 
   std::chrono::milliseconds _connectTimeout;
   std::chrono::milliseconds _idleTimeout;
+  std::chrono::milliseconds _resolveCacheTtl;     // 0 disables caching
+  std::chrono::milliseconds _resolveNegativeTtl;  // for failed lookups
+  std::chrono::milliseconds _connectAttemptDelay; // RFC 8305 attempt delay
   unsigned _maxConnectRetries;
+  uint32_t _maxQueuedRequests;  // bound of the request queue
+  // requests sent per round from each priority class, high to low
+  std::array<uint32_t, numRequestPriorities> _priorityWeights;
+  // header carrying the remaining time of a request, empty to disable
+  std::string _deadlineHeader;
+  std::size_t _maxResponseSize;  // bytes of one response, 0 is unlimited
+  std::size_t _memoryBudget;     // buffered response bytes, 0 is unlimited
+  int _ioContext;  // io_context of the EventLoopService, -1 least loaded
+  std::chrono::microseconds _socketBusyPoll;  // SO_BUSY_POLL, 0 disables
+  // runs request callbacks, null runs them on the IO thread
+  std::shared_ptr<CallbackExecutor> _callbackExecutor;
+
+  // endpoint circuit breaker, disabled if the failure ratio is 0
+  double _breakerFailureRatio;
+  unsigned _breakerMinRequests;
+  std::chrono::milliseconds _breakerWindow;
+  std::chrono::milliseconds _breakerOpenTimeout;
 
   AuthenticationType _authenticationType;
   std::string _user;
@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_UNIQUE_FUNCTION_H
+#define ARANGO_CXX_DRIVER_UNIQUE_FUNCTION_H 1
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+template <typename Signature>
+class unique_function;
+
+/// @brief Move-only replacement for std::function. Callables of up to
+/// `inlineSize` bytes are stored in place, so the typical lambda that
+/// captures a few pointers or a std::function never allocates. Larger
+/// ones go to the heap. Move-only captures (unique_ptr, promises) work.
+template <typename R, typename... Args>
+class unique_function<R(Args...)> {
+ public:
+  static constexpr std::size_t inlineSize = 64;
+
+  unique_function() noexcept : _ops(nullptr) {}
+  unique_function(std::nullptr_t) noexcept : _ops(nullptr) {}
+
+  template <typename F, typename D = std::decay_t<F>,
+            typename = std::enable_if_t<
+                !std::is_same_v<D, unique_function> &&
+                std::is_invocable_r_v<R, D&, Args...>>>
+  unique_function(F&& f) : _ops(nullptr) {
+    if constexpr (std::is_pointer_v<D> || std::is_member_pointer_v<D> ||
+                  IsStdFunction<D>::value) {
+      if (!f) {
+        return;  // stay empty, like std::function
+      }
+    }
+    if constexpr (fitsInline<D>) {
+      ::new (static_cast<void*>(&_storage)) D(std::forward<F>(f));
+      _ops = &InlineOps<D>::ops;
+    } else {
+      ::new (static_cast<void*>(&_storage)) D*(new D(std::forward<F>(f)));
+      _ops = &HeapOps<D>::ops;
+    }
+  }
+
+  unique_function(unique_function&& other) noexcept : _ops(other._ops) {
+    if (_ops != nullptr) {
+      _ops->move(&other._storage, &_storage);
+      other._ops = nullptr;
+    }
+  }
+
+  unique_function& operator=(unique_function&& other) noexcept {
+    if (this != &other) {
+      reset();
+      if (other._ops != nullptr) {
+        other._ops->move(&other._storage, &_storage);
+        _ops = other._ops;
+        other._ops = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  unique_function& operator=(std::nullptr_t) noexcept {
+    reset();
+    return *this;
+  }
+
+  template <typename F, typename D = std::decay_t<F>,
+            typename = std::enable_if_t<
+                !std::is_same_v<D, unique_function> &&
+                std::is_invocable_r_v<R, D&, Args...>>>
+  unique_function& operator=(F&& f) {
+    return *this = unique_function(std::forward<F>(f));
+  }
+
+  unique_function(unique_function const&) = delete;
+  unique_function& operator=(unique_function const&) = delete;
+
+  ~unique_function() { reset(); }
+
+  explicit operator bool() const noexcept { return _ops != nullptr; }
+
+  /// @throws std::bad_function_call if empty
+  R operator()(Args... args) {
+    if (_ops == nullptr) {
+      throw std::bad_function_call();
+    }
+    return _ops->invoke(&_storage, std::forward<Args>(args)...);
+  }
+
+ private:
+  struct Ops {
+    R (*invoke)(void*, Args&&...);
+    /// move-construct into `to` and destroy `from`
+    void (*move)(void* from, void* to) noexcept;
+    void (*destroy)(void*) noexcept;
+  };
+
+  template <typename T>
+  struct IsStdFunction : std::false_type {};
+  template <typename S>
+  struct IsStdFunction<std::function<S>> : std::true_type {};
+
+  template <typename D>
+  static constexpr bool fitsInline =
+      sizeof(D) <= inlineSize && alignof(D) <= alignof(std::max_align_t) &&
+      std::is_nothrow_move_constructible_v<D>;
+
+  template <typename D>
+  struct InlineOps {
+    static R invoke(void* s, Args&&... args) {
+      if constexpr (std::is_void_v<R>) {
+        std::invoke(*static_cast<D*>(s), std::forward<Args>(args)...);
+      } else {
+        return std::invoke(*static_cast<D*>(s), std::forward<Args>(args)...);
+      }
+    }
+    static void move(void* from, void* to) noexcept {
+      ::new (to) D(std::move(*static_cast<D*>(from)));
+      static_cast<D*>(from)->~D();
+    }
+    static void destroy(void* s) noexcept { static_cast<D*>(s)->~D(); }
+    static constexpr Ops ops{&invoke, &move, &destroy};
+  };
+
+  template <typename D>
+  struct HeapOps {
+    static R invoke(void* s, Args&&... args) {
+      if constexpr (std::is_void_v<R>) {
+        std::invoke(**static_cast<D**>(s), std::forward<Args>(args)...);
+      } else {
+        return std::invoke(**static_cast<D**>(s), std::forward<Args>(args)...);
+      }
+    }
+    static void move(void* from, void* to) noexcept {
+      ::new (to) D*(*static_cast<D**>(from));
+    }
+    static void destroy(void* s) noexcept { delete *static_cast<D**>(s); }
+    static constexpr Ops ops{&invoke, &move, &destroy};
+  };
+
+  void reset() noexcept {
+    if (_ops != nullptr) {
+      _ops->destroy(&_storage);
+      _ops = nullptr;
+    }
+  }
+
+ private:
+  std::aligned_storage_t<inlineSize, alignof(std::max_align_t)> _storage;
+  Ops const* _ops;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_ALLOCATED_PAYLOAD_H
+#define ARANGO_CXX_DRIVER_ALLOCATED_PAYLOAD_H 1
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include <fuerte/message.h>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief Response body in storage of a PayloadAllocator while it is
+/// received. The storage goes back to the allocator once the response and
+/// all views of it are gone, or right away if it is never handed out.
+///
+/// Not thread-safe, only used on the IO thread.
+class AllocatedPayload {
+ public:
+  AllocatedPayload() : _data(nullptr), _size(0), _capacity(0) {}
+
+  /// @brief storage for `size` bytes, false if the allocator declined
+  bool allocate(std::shared_ptr<PayloadAllocator> const& allocator,
+                std::size_t size) {
+    reset();
+    uint8_t* data = allocator->allocate(size);
+    if (data == nullptr) {
+      return false;
+    }
+    _owner.reset(data, [allocator, size](uint8_t* p) {
+      allocator->deallocate(p, size);
+    });
+    _data = data;
+    _capacity = size;
+    return true;
+  }
+
+  /// @brief storage is allocated
+  bool active() const { return _data != nullptr; }
+
+  /// @brief space for the bytes still to come
+  asio_ns::mutable_buffer tail() {
+    return asio_ns::mutable_buffer(_data + _size, _capacity - _size);
+  }
+
+  void append(void const* data, std::size_t n) {
+    assert(n <= _capacity - _size);
+    std::memcpy(_data + _size, data, n);
+    _size += n;
+  }
+
+  /// @brief `n` bytes were written to tail()
+  void advance(std::size_t n) {
+    assert(n <= _capacity - _size);
+    _size += n;
+  }
+
+  /// @brief hand out the received bytes
+  PayloadSlice release() {
+    PayloadSlice slice(std::move(_owner), _data, _size);
+    reset();
+    return slice;
+  }
+
+  /// @brief give back the storage, unless it was handed out
+  void reset() {
+    _owner.reset();
+    _data = nullptr;
+    _size = _capacity = 0;
+  }
+
+  /// @brief copy of `size` bytes in storage of `allocator`, empty if it
+  /// declined
+  static PayloadSlice copy(std::shared_ptr<PayloadAllocator> const& allocator,
+                           uint8_t const* data, std::size_t size) {
+    AllocatedPayload payload;
+    if (size == 0 || !payload.allocate(allocator, size)) {
+      return PayloadSlice();
+    }
+    payload.append(data, size);
+    return payload.release();
+  }
+
+ private:
+  std::shared_ptr<uint8_t> _owner;
+  uint8_t* _data;
+  std::size_t _size;
+  std::size_t _capacity;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
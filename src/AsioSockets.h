@@ -23,39 +23,258 @@
 #ifndef ARANGO_CXX_DRIVER_ASIO_CONNECTION_H
 #define ARANGO_CXX_DRIVER_ASIO_CONNECTION_H 1
 
+#include <fuerte/FuerteLogger.h>
 #include <fuerte/asio_ns.h>
 #include <fuerte/loop.h>
 
+#include <cassert>
+#include <functional>
+#include <memory>
+
+#include "ResolverCache.h"
+#include "TlsSessionCache.h"
+
 namespace arangodb { namespace fuerte { inline namespace v1 {
   
+/// @brief order endpoints by alternating address families, starting with
+/// the family of the first result (RFC 8305, section 4)
+inline ResolverCache::Endpoints interleaveFamilies(
+    ResolverCache::Endpoints const& endpoints) {
+  if (endpoints.size() <= 2) {
+    return endpoints;
+  }
+  bool const firstV6 = endpoints.front().address().is_v6();
+  ResolverCache::Endpoints primary, secondary;
+  for (auto const& ep : endpoints) {
+    (ep.address().is_v6() == firstV6 ? primary : secondary).push_back(ep);
+  }
+  ResolverCache::Endpoints result;
+  result.reserve(endpoints.size());
+  size_t i = 0;
+  while (i < primary.size() || i < secondary.size()) {
+    if (i < primary.size()) {
+      result.push_back(primary[i]);
+    }
+    if (i < secondary.size()) {
+      result.push_back(secondary[i]);
+    }
+    i++;
+  }
+  return result;
+}
+
+/// @brief staggered parallel connection attempts (RFC 8305 "Happy Eyeballs").
+/// The next address is tried whenever the previous attempt failed or did not
+/// succeed within the attempt delay. The first established socket wins and
+/// is handed to the callback, all other attempts are closed.
+/// The connector owns its sockets and timer, pending handlers keep it alive.
+/// Only use on the IO-Thread that owns the executor.
+class EndpointConnector
+    : public std::enable_shared_from_this<EndpointConnector> {
+ public:
+  using Executor = asio_ns::ip::tcp::socket::executor_type;
+  /// receives the established socket, or nullptr on error
+  using Callback = std::function<void(asio_ns::error_code const&,
+                                      asio_ns::ip::tcp::socket*)>;
+
+  EndpointConnector(Executor const& executor,
+                    ResolverCache::Endpoints endpoints,
+                    std::chrono::milliseconds delay, Callback done)
+      : _executor(executor),
+        _endpoints(interleaveFamilies(endpoints)),
+        _delay(delay),
+        _timer(executor),
+        _done(std::move(done)) {}
+
+  void start() { startAttempt(); }
+
+  /// abort all attempts, the callback is invoked with operation_aborted
+  void cancel() {
+    if (_finished || _canceled) {
+      return;
+    }
+    _canceled = true;
+    asio_ns::error_code ec;
+    _timer.cancel(ec);
+    for (auto& sock : _attempts) {
+      if (sock->is_open()) {
+        sock->close(ec);
+      }
+    }
+  }
+
+  /// the owner is going away, drop the callback and abort all attempts.
+  /// Handlers still pending afterwards only touch the connector itself.
+  void detach() {
+    _done = nullptr;
+    cancel();
+  }
+
+ private:
+  void startAttempt() {
+    assert(_next < _endpoints.size());
+    size_t const idx = _next++;
+    _attempts.emplace_back(
+        std::make_unique<asio_ns::ip::tcp::socket>(_executor));
+    _pending++;
+    auto self = shared_from_this();
+    _attempts.back()->async_connect(
+        _endpoints[idx],
+        [self, idx](asio_ns::error_code const& ec) { self->onConnect(idx, ec); });
+
+    if (_next < _endpoints.size() && _delay.count() > 0) {
+      _timer.expires_after(_delay);
+      _timer.async_wait([self, idx](asio_ns::error_code const& ec) {
+        // ignore stale timers, another attempt was started meanwhile
+        if (!ec && !self->_finished && !self->_canceled &&
+            self->_next == idx + 1) {
+          self->startAttempt();
+        }
+      });
+    }
+  }
+
+  void onConnect(size_t idx, asio_ns::error_code const& ec) {
+    _pending--;
+    if (_finished) {
+      return;  // lost the race
+    }
+
+    if (!ec && !_canceled) {
+      _finished = true;
+      asio_ns::error_code ignore;
+      _timer.cancel(ignore);
+      for (size_t i = 0; i < _attempts.size(); i++) {
+        if (i != idx && _attempts[i]->is_open()) {
+          _attempts[i]->close(ignore);
+        }
+      }
+      finish(ec, _attempts[idx].get());
+      return;
+    }
+
+    _lastError = _canceled ? asio_ns::error::operation_aborted : ec;
+    if (!_canceled && _next < _endpoints.size() && _next == idx + 1) {
+      // do not wait for the attempt delay after a failure
+      startAttempt();
+    } else if (_pending == 0) {
+      _finished = true;
+      finish(_lastError, nullptr);
+    }
+  }
+
+  /// the callback may own the connection, do not keep it alive
+  void finish(asio_ns::error_code const& ec, asio_ns::ip::tcp::socket* sock) {
+    if (!_done) {
+      return;  // detached
+    }
+    Callback done = std::move(_done);
+    _done = nullptr;
+    done(ec, sock);
+  }
+
+ private:
+  Executor const _executor;
+  ResolverCache::Endpoints const _endpoints;
+  std::chrono::milliseconds const _delay;
+  asio_ns::steady_timer _timer;
+  Callback _done;
+
+  std::vector<std::unique_ptr<asio_ns::ip::tcp::socket>> _attempts;
+  asio_ns::error_code _lastError;
+  size_t _next = 0;
+  size_t _pending = 0;
+  bool _finished = false;
+  bool _canceled = false;
+};
+
 namespace {
-template <typename SocketT, typename F>
+/// let the kernel busy poll the device queue for a while before a
+/// blocking receive sleeps (SO_BUSY_POLL, Linux only)
+inline void setBusyPoll(asio_ns::ip::tcp::socket& socket,
+                        std::chrono::microseconds t) {
+#ifdef SO_BUSY_POLL
+  if (t.count() > 0) {
+    using busy_poll = asio_ns::detail::socket_option::integer<SOL_SOCKET,
+                                                              SO_BUSY_POLL>;
+    asio_ns::error_code ec;
+    socket.set_option(busy_poll(static_cast<int>(t.count())), ec);
+    if (ec) {
+      FUERTE_LOG_ERROR << "unable to set SO_BUSY_POLL: " << ec.message()
+                       << "\n";
+    }
+  }
+#endif
+}
+
+template <typename F>
 void resolveConnect(detail::ConnectionConfiguration const& config,
+                    ResolverCache& cache,
                     asio_ns::ip::tcp::resolver& resolver,
-                    SocketT& socket,
+                    std::shared_ptr<EndpointConnector>& connector,
+                    asio_ns::ip::tcp::socket& socket,
                     F&& done) {
-  auto cb = [&socket, done = std::forward<F>(done)]
-  (asio_ns::error_code const& ec,
-   asio_ns::ip::tcp::resolver::iterator it) {
+  auto connect = [&config, &cache, &connector, &socket](
+                     ResolverCache::Endpoints endpoints, auto done) {
+    // the callback is dropped via EndpointConnector::detach() before the
+    // references captured here go away, it is never invoked afterwards
+    connector = std::make_shared<EndpointConnector>(
+        socket.get_executor(), std::move(endpoints),
+        config._connectAttemptDelay,
+        [&config, &cache, &connector, &socket, done = std::move(done)](
+            asio_ns::error_code const& ec,
+            asio_ns::ip::tcp::socket* established) mutable {
+          connector.reset();  // finished, `done` may destroy the socket
+          if (!ec) {
+            socket = std::move(*established);
+            setBusyPoll(socket, config._socketBusyPoll);
+          } else if (ec != asio_ns::error::operation_aborted) {
+            // no address worked, they may be stale (i.e. DNS failover)
+            cache.invalidate(config._host, config._port);
+          }
+          done(ec);
+        });
+    connector->start();
+  };
+
+  asio_ns::error_code ec;
+  ResolverCache::Endpoints endpoints;
+  if (cache.lookup(config._host, config._port, config._resolveCacheTtl,
+                   config._resolveNegativeTtl, endpoints, ec)) {
+    if (ec) {  // negative entry, never invoke the callback inline
+      asio_ns::post(socket.get_executor(),
+                    [ec, done = std::forward<F>(done)] { done(ec); });
+    } else {
+      connect(std::move(endpoints), std::forward<F>(done));
+    }
+    return;
+  }
+
+  auto cb = [&config, &cache, connect, done = std::forward<F>(done)](
+                asio_ns::error_code const& ec,
+                asio_ns::ip::tcp::resolver::results_type results) mutable {
+    ResolverCache::Endpoints endpoints;
+    for (auto const& entry : results) {
+      endpoints.push_back(entry.endpoint());
+    }
+    if (ec == asio_ns::error::operation_aborted) {
+      done(ec);  // canceled, says nothing about the host
+      return;
+    }
+    cache.store(config._host, config._port, endpoints, ec);
     if (ec) { // error
       done(ec);
       return;
     }
-    
     // A successful resolve operation is guaranteed to pass a
     // non-empty range to the handler.
-    auto cb = [done](asio_ns::error_code const& ec,
-                     asio_ns::ip::tcp::resolver::iterator const&) {
-      done(ec);
-    };
-    asio_ns::async_connect(socket, it, std::move(cb));
+    connect(std::move(endpoints), std::move(done));
   };
-  
+
   // windows does not like async_resolve
 #ifdef _WIN32
-  asio_ns::error_code ec;
-  auto it = resolver.resolve(config._host, config._port, ec);
-  cb(ec, it);
+  auto results = resolver.resolve(config._host, config._port, ec);
+  cb(ec, std::move(results));
 #else
   // Resolve the host asynchronous into a series of endpoints
   resolver.async_resolve(config._host, config._port, std::move(cb));
@@ -69,23 +288,30 @@ struct Socket {};
 
 template<>
 struct Socket<SocketType::Tcp>  {
-  Socket(EventLoopService&,
+  Socket(EventLoopService& loop,
          asio_ns::io_context& ctx)
-    : resolver(ctx), socket(ctx) {}
+    : loop(loop), resolver(ctx), socket(ctx) {}
   
   ~Socket() {
+    if (connector) {  // pending handlers must not reach this socket
+      connector->detach();
+    }
     try {
-      resolver.cancel();
       shutdown();
     } catch(...) {}
   }
   
   template<typename F>
   void connect(detail::ConnectionConfiguration const& config, F&& done) {
-    resolveConnect(config, resolver, socket, std::forward<F>(done));
+    resolveConnect(config, loop.resolverCache(), resolver, connector, socket,
+                   std::forward<F>(done));
   }
   
   void shutdown() {
+    resolver.cancel();
+    if (connector) {
+      connector->cancel();
+    }
     if (socket.is_open()) {
       asio_ns::error_code ec; // prevents exceptions
       socket.cancel(ec);
@@ -96,18 +322,22 @@ struct Socket<SocketType::Tcp>  {
     }
   }
   
+  EventLoopService& loop;
   asio_ns::ip::tcp::resolver resolver;
+  std::shared_ptr<EndpointConnector> connector;
   asio_ns::ip::tcp::socket socket;
 };
 
 template<>
 struct Socket<fuerte::SocketType::Ssl> {
   Socket(EventLoopService& loop, asio_ns::io_context& ctx)
-  : resolver(ctx), socket(ctx, loop.sslContext()) {}
+  : loop(loop), resolver(ctx), socket(ctx, loop.sslContext()) {}
   
   ~Socket() {
+    if (connector) {  // pending handlers must not reach this socket
+      connector->detach();
+    }
     try {
-      resolver.cancel();
       shutdown();
     } catch(...) {}
   }
@@ -128,14 +358,33 @@ struct Socket<fuerte::SocketType::Ssl> {
       } else {
         socket.set_verify_mode(asio_ns::ssl::verify_none);
       }
-      
-      socket.async_handshake(asio_ns::ssl::stream_base::client, std::move(done));
+
+      // try to resume the last session with this endpoint, never share
+      // sessions between verified and unverified connections
+      sessionKey = config._host + ':' + config._port +
+                   (config._verifyHost ? "+verify" : "");
+      TlsSessionCache& cache = loop.tlsSessionCache();
+      cache.prepare(socket.native_handle(), sessionKey);
+
+      socket.async_handshake(asio_ns::ssl::stream_base::client,
+                             [&cache, key = sessionKey, done = std::move(done)]
+                             (asio_ns::error_code const& ec) {
+        if (ec && ec != asio_ns::error::operation_aborted) {
+          cache.remove(key);
+        }
+        done(ec);
+      });
     };
     
-    resolveConnect(config, resolver, socket.next_layer(), std::move(cb));
+    resolveConnect(config, loop.resolverCache(), resolver, connector,
+                   socket.next_layer(), std::move(cb));
   }
   
   void shutdown() {
+    resolver.cancel();
+    if (connector) {
+      connector->cancel();
+    }
     if (socket.lowest_layer().is_open()) {
       asio_ns::error_code ec; // ignored
       socket.lowest_layer().cancel(ec);
@@ -148,7 +397,11 @@ struct Socket<fuerte::SocketType::Ssl> {
     }
   }
   
+  EventLoopService& loop;
   asio_ns::ip::tcp::resolver resolver;
+  std::shared_ptr<EndpointConnector> connector;
+  /// TLS session cache key, referenced by the SSL object
+  std::string sessionKey;
   asio_ns::ssl::stream<asio_ns::ip::tcp::socket> socket;
 };
 
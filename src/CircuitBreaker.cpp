@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CircuitBreaker.h"
+
+#include <algorithm>
+
+#include <fuerte/FuerteLogger.h>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+CircuitBreaker::CircuitBreaker(detail::ConnectionConfiguration const& config)
+    : _failureRatio(config._breakerFailureRatio),
+      _minRequests(std::max(config._breakerMinRequests, 1u)),
+      _window(config._breakerWindow),
+      _openTimeout(config._breakerOpenTimeout),
+      _state(State::Closed),
+      _successes(0),
+      _retryAt(0),
+      _failures(0),
+      _windowStart(clock::now()) {}
+
+bool CircuitBreaker::allowRequest(bool& probe) {
+  probe = false;
+  if (_state.load(std::memory_order_acquire) == State::Closed) {
+    return true;  // fast path
+  }
+
+  // open or half-open: only one probe per open timeout may pass
+  clock::rep now = clock::now().time_since_epoch().count();
+  clock::rep retryAt = _retryAt.load(std::memory_order_acquire);
+  while (now >= retryAt) {
+    if (_retryAt.compare_exchange_weak(retryAt, now + _openTimeout.count())) {
+      State exp = State::Open;
+      _state.compare_exchange_strong(exp, State::HalfOpen);
+      FUERTE_LOG_DEBUG << "circuit breaker half-open, sending probe\n";
+      probe = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+void CircuitBreaker::releaseProbe() {
+  // half-open: the granted probe is the only one outstanding
+  if (_state.load(std::memory_order_acquire) == State::HalfOpen) {
+    _retryAt.store(0, std::memory_order_release);
+  }
+}
+
+void CircuitBreaker::reportSuccess(bool probe) {
+  if (_state.load(std::memory_order_acquire) == State::Closed) {
+    _successes.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (!probe) {
+    return;  // sent before the breaker opened, says little about now
+  }
+
+  // the endpoint answered the probe, close the breaker again
+  std::lock_guard<std::mutex> guard(_mutex);
+  if (_state.load() != State::Closed) {
+    FUERTE_LOG_DEBUG << "circuit breaker closed\n";
+    _failures = 0;
+    _successes.store(0, std::memory_order_relaxed);
+    _windowStart = clock::now();
+    _state.store(State::Closed, std::memory_order_release);
+  }
+}
+
+void CircuitBreaker::reportFailure(bool probe) {
+  if (_state.load(std::memory_order_acquire) != State::Closed && !probe) {
+    return;  // sent before the breaker opened, says little about now
+  }
+
+  auto now = clock::now();
+  std::lock_guard<std::mutex> guard(_mutex);
+  if (_state.load() != State::Closed) {
+    open(now);  // probe failed, wait for another open timeout
+    return;
+  }
+
+  if (now - _windowStart >= _window) {  // start a new observation window
+    _failures = 0;
+    _successes.store(0, std::memory_order_relaxed);
+    _windowStart = now;
+  }
+
+  _failures++;
+  uint32_t total = _failures + _successes.load(std::memory_order_relaxed);
+  if (total >= _minRequests && _failures >= _failureRatio * total) {
+    open(now);
+  }
+}
+
+void CircuitBreaker::open(clock::time_point now) {
+  FUERTE_LOG_DEBUG << "circuit breaker open\n";
+  _retryAt.store((now + _openTimeout).time_since_epoch().count(),
+                 std::memory_order_release);
+  _state.store(State::Open, std::memory_order_release);
+}
+
+}}}  // namespace arangodb::fuerte::v1
@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_CIRCUIT_BREAKER_H
+#define ARANGO_CXX_DRIVER_CIRCUIT_BREAKER_H 1
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include <fuerte/types.h>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief CircuitBreaker tracks the error rate of a single endpoint and
+/// is shared by all connections to that endpoint.
+///
+///  Closed +-----(error rate exceeded)-----> Open
+///    ^                                       |
+///    |                                 (open timeout)
+///    |                                       v
+///    +---------(probe succeeded)------- HalfOpen
+///
+/// While the breaker is open requests fail fast with Error::CircuitOpen.
+/// Once the open timeout has elapsed a single probe request is let through,
+/// its outcome decides whether the breaker closes or stays open. Late
+/// successes of requests sent before the breaker opened do not count.
+class CircuitBreaker {
+ public:
+  enum class State : uint8_t { Closed = 0, Open = 1, HalfOpen = 2 };
+
+  explicit CircuitBreaker(detail::ConnectionConfiguration const&);
+
+  CircuitBreaker(CircuitBreaker const&) = delete;
+  CircuitBreaker& operator=(CircuitBreaker const&) = delete;
+
+  /// @brief may a request be sent to the endpoint, thread-safe. `probe`
+  /// is set for the single request let through an open breaker.
+  bool allowRequest(bool& probe);
+
+  /// @brief the probe granted by allowRequest() was not sent, i.e. the
+  /// request queue was full. The next request may probe right away.
+  void releaseProbe();
+
+  /// @brief report a successful request, thread-safe. `probe` as returned
+  /// by allowRequest(), only the probe closes an open breaker.
+  void reportSuccess(bool probe);
+
+  /// @brief report a failed request or connect attempt, thread-safe.
+  /// `probe` as returned by allowRequest(), only the probe re-opens a
+  /// breaker that is not closed.
+  void reportFailure(bool probe);
+
+  State state() const { return _state.load(std::memory_order_acquire); }
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  /// open the breaker, needs _mutex
+  void open(clock::time_point now);
+
+ private:
+  double const _failureRatio;
+  uint32_t const _minRequests;
+  clock::duration const _window;
+  clock::duration const _openTimeout;
+
+  std::atomic<State> _state;
+  /// successful requests in the current window, counted without lock
+  std::atomic<uint32_t> _successes;
+  /// earliest point in time for the next probe request
+  std::atomic<clock::rep> _retryAt;
+
+  std::mutex _mutex;
+  /// failed requests in the current window
+  uint32_t _failures;
+  clock::time_point _windowStart;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
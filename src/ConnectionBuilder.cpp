@@ -25,6 +25,8 @@
 #include <fuerte/connection.h>
 #include <fuerte/FuerteLogger.h>
 
+#include <atomic>
+
 #include <boost/algorithm/string.hpp>
 
 #include "HttpConnection.h"
@@ -70,6 +72,55 @@ std::shared_ptr<Connection> ConnectionBuilder::connect(EventLoopService& loop) {
 
   return result;
 }
+
+// Open a number of connections ahead of time
+std::vector<std::shared_ptr<Connection>> ConnectionBuilder::prewarm(
+    EventLoopService& loop, std::size_t count,
+    std::function<void(std::size_t)> done) {
+  std::vector<std::shared_ptr<Connection>> result;
+  if (count == 0) {
+    if (done) {
+      done(0);
+    }
+    return result;
+  }
+
+  struct Progress {
+    std::atomic<std::size_t> pending;
+    std::atomic<std::size_t> connected;
+    std::function<void(std::size_t)> done;
+  };
+  auto progress = std::make_shared<Progress>();
+  progress->pending.store(count);
+  progress->connected.store(0);
+  progress->done = std::move(done);
+
+  ConnectionBuilder builder(*this);
+  result.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    // every connection reports its first attempt exactly once
+    auto reported = std::make_shared<std::atomic<bool>>(false);
+    builder._conf._onConnect = [progress, reported,
+                                cb = _conf._onConnect](Error err) {
+      if (cb) {
+        try {
+          cb(err);
+        } catch (...) {}
+      }
+      if (reported->exchange(true)) {
+        return;
+      }
+      if (err == Error::NoError) {
+        progress->connected.fetch_add(1);
+      }
+      if (progress->pending.fetch_sub(1) == 1 && progress->done) {
+        progress->done(progress->connected.load());
+      }
+    };
+    result.push_back(builder.connect(loop));
+  }
+  return result;
+}
   
 void parseSchema(std::string const& schema,
                  detail::ConnectionConfiguration& conf) {
@@ -30,12 +30,27 @@ template <SocketType ST>
 GeneralConnection<ST>::GeneralConnection(
     EventLoopService& loop, detail::ConnectionConfiguration const& config)
     : Connection(config),
-      _io_context(loop.nextIOContext()),
+      _ioIndex(loop.acquireIOContext(config._ioContext)),
+      _io_context(loop.ioContext(_ioIndex)),
       _loop(loop),
+      _pools(loop.objectPools(_ioIndex)),
       _proto(nullptr),
       _timeout(*_io_context),
+      _queueTimeout(*_io_context),
+      _breaker(config._breakerFailureRatio > 0
+                   ? loop.circuitBreaker(endpoint(), config)
+                   : nullptr),
       _state(Connection::State::Disconnected),
-      _numQueued(0) {}
+      _numQueued(0),
+      _bufferedBytes(0),
+      _hasSpaceWaiters(false),
+      _queueDeadline(noDeadline) {}
+
+template <SocketType ST>
+GeneralConnection<ST>::~GeneralConnection() {
+  _loop.releaseMemory(_bufferedBytes.load());
+  _loop.releaseIOContext(_ioIndex);
+}
 
 /// @brief cancel the connection, unusable afterwards
 template <SocketType ST>
@@ -51,6 +66,89 @@ void GeneralConnection<ST>::cancel() {
   });
 }
 
+/// @brief cancel a single request
+template <SocketType ST>
+void GeneralConnection<ST>::cancelRequest(MessageID mid) {
+  FUERTE_LOG_DEBUG << "cancelRequest: " << mid << " this=" << this << "\n";
+  asio_ns::post(*_io_context, [self(weak_from_this()), this, mid] {
+    if (auto s = self.lock()) {
+      abortRequest(mid);  // nothing to do if it is done already
+    }
+  });
+}
+
+template <SocketType ST>
+void GeneralConnection<ST>::notifyOnQueueSpace(std::function<void()> cb) {
+  {
+    std::lock_guard<std::mutex> guard(_spaceMutex);
+    _spaceWaiters.push_back(std::move(cb));
+    _hasSpaceWaiters.store(true, std::memory_order_seq_cst);
+  }
+  // the queue might have drained before we registered,
+  // see releaseQueueSlot() for the ordering
+  uint32_t q = _numQueued.load(std::memory_order_seq_cst);
+  if (q <= _config._maxQueuedRequests / 2) {
+    notifySpaceWaiters();
+  }
+}
+
+template <SocketType ST>
+void GeneralConnection<ST>::notifySpaceWaiters() {
+  std::vector<std::function<void()>> waiters;
+  {
+    std::lock_guard<std::mutex> guard(_spaceMutex);
+    waiters.swap(_spaceWaiters);
+    _hasSpaceWaiters.store(false, std::memory_order_release);
+  }
+  for (auto& cb : waiters) {
+    try {
+      cb();
+    } catch (...) {}
+  }
+}
+
+template <SocketType ST>
+void GeneralConnection<ST>::watchDeadline(
+    std::chrono::steady_clock::time_point deadline) {
+  if (deadline == std::chrono::steady_clock::time_point::max()) {
+    return;
+  }
+  auto ticks = deadline.time_since_epoch().count();
+  auto armed = _queueDeadline.load();
+  while (ticks < armed) {
+    if (_queueDeadline.compare_exchange_weak(armed, ticks)) {
+      asio_ns::post(*_io_context, [self(weak_from_this()), this] {
+        if (auto s = self.lock()) {
+          armQueueTimeout();
+        }
+      });
+      return;
+    }
+  }
+}
+
+template <SocketType ST>
+void GeneralConnection<ST>::armQueueTimeout() {
+  using clock = std::chrono::steady_clock;
+  auto ticks = _queueDeadline.load();
+  if (ticks == noDeadline) {
+    return;  // fired already, a later deadline re-arms it
+  }
+  // expires_at cancels the wait for a later deadline
+  _queueTimeout.expires_at(clock::time_point(clock::duration(ticks)));
+  _queueTimeout.async_wait([self(weak_from_this()),
+                            this](asio_ns::error_code const& ec) {
+    std::shared_ptr<Connection> s;
+    if (ec || !(s = self.lock())) {  // was canceled / deallocated
+      return;
+    }
+    // an exchange, so requests queued before a concurrent watchDeadline()
+    // are visible to expireQueued()
+    _queueDeadline.exchange(noDeadline);
+    watchDeadline(expireQueued(clock::now()));
+  });
+}
+
 // Activate this connection.
 template <SocketType ST>
 void GeneralConnection<ST>::startConnection() {
@@ -60,6 +158,9 @@ void GeneralConnection<ST>::startConnection() {
     FUERTE_LOG_DEBUG << "startConnection: this=" << this << "\n";
     auto cb = [self = Connection::shared_from_this()] {
       auto* thisPtr = static_cast<GeneralConnection<ST>*>(self.get());
+      if (thisPtr->_state.load() != Connection::State::Connecting) {
+        return;  // canceled before we got here
+      }
       thisPtr->tryConnect(thisPtr->_config._maxConnectRetries);
     };
     asio_ns::post(*this->_io_context, std::move(cb));
@@ -97,7 +198,7 @@ void GeneralConnection<ST>::shutdownConnection(const Error err,
   }
 
   // clear buffer of received messages
-  _receiveBuffer.consume(_receiveBuffer.size());
+  _receiveBuffer.clear();  // a still pending read is dropped on commit
   
   _proto.reset(); // always wait until the end
 }
@@ -126,6 +227,9 @@ void GeneralConnection<ST>::tryConnect(unsigned retries) {
   
   _proto = std::make_unique<fuerte::Socket<ST>>(_loop, *_io_context);
   _proto->connect(_config, [self, this, retries](auto const& ec) {
+    if (_state.load() != Connection::State::Connecting) {
+      return;  // canceled meanwhile, cancel() cleans up
+    }
     _timeout.cancel();
     if (!ec) {
       finishConnect();
@@ -135,7 +239,9 @@ void GeneralConnection<ST>::tryConnect(unsigned retries) {
     if (retries > 0 && ec != asio_ns::error::operation_aborted) {
       tryConnect(retries - 1);
     } else {
+      reportFailure(probeQueued());
       _state.store(Connection::State::Failed, std::memory_order_release);
+      onConnect(Error::CouldNotConnect);
       drainQueue(Error::CouldNotConnect);
       shutdownConnection(Error::CouldNotConnect,
                          "connecting failed: " + ec.message());
@@ -156,6 +262,27 @@ void GeneralConnection<ST>::restartConnection(const Error error) {
   }
 }
 
+template <SocketType ST>
+Error GeneralConnection<ST>::reserveResponse(std::size_t& charged,
+                                             uint64_t size) {
+  if (_config._maxResponseSize > 0 && size > _config._maxResponseSize) {
+    return Error::ResponseTooLarge;
+  }
+  if (size <= charged) {
+    return Error::NoError;
+  }
+  // only the IO thread changes the counter, others just read it
+  std::size_t more = static_cast<std::size_t>(size - charged);
+  std::size_t buffered = _bufferedBytes.load(std::memory_order_relaxed);
+  if ((_config._memoryBudget > 0 && buffered + more > _config._memoryBudget) ||
+      !_loop.chargeMemory(more)) {
+    return Error::MemoryBudgetExceeded;
+  }
+  _bufferedBytes.store(buffered + more, std::memory_order_relaxed);
+  charged += more;
+  return Error::NoError;
+}
+
 // asyncReadSome reads the next bytes from the server.
 template <SocketType ST>
 void GeneralConnection<ST>::asyncReadSome() {
@@ -165,20 +292,34 @@ void GeneralConnection<ST>::asyncReadSome() {
 
   // Start reading data from the network.
 
-  // reserve 32kB in output buffer
-  auto mutableBuff = _receiveBuffer.prepare(READ_BLOCK_SIZE);
-  
+  // space for the next read, sized by the previous reads
+  auto mutableBuff = _receiveBuffer.prepare();
+
   _proto->socket.async_read_some(mutableBuff, [self = shared_from_this()]
                                  (auto const& ec, size_t nread) {
     FUERTE_LOG_TRACE << "received " << nread << " bytes\n";
     
-    // received data is "committed" from output sequence to input sequence
+    // received data is appended to the unparsed bytes
     auto* thisPtr = static_cast<GeneralConnection<ST>*>(self.get());
     thisPtr->_receiveBuffer.commit(nread);
     thisPtr->asyncReadCallback(ec);
   });
 }
 
+// asyncReadInto reads the next bytes straight into the given buffer.
+template <SocketType ST>
+void GeneralConnection<ST>::asyncReadInto(asio_ns::mutable_buffer target) {
+  FUERTE_LOG_TRACE << "asyncReadInto: this=" << this << "\n";
+  assert(_receiveBuffer.size() == 0);
+
+  _proto->socket.async_read_some(target, [self = shared_from_this()]
+                                 (auto const& ec, size_t nread) {
+    FUERTE_LOG_TRACE << "received " << nread << " bytes in place\n";
+    auto* thisPtr = static_cast<GeneralConnection<ST>*>(self.get());
+    thisPtr->asyncReadIntoCallback(ec, nread);
+  });
+}
+
 template class arangodb::fuerte::GeneralConnection<SocketType::Tcp>;
 template class arangodb::fuerte::GeneralConnection<SocketType::Ssl>;
 #ifdef ASIO_HAS_LOCAL_SOCKETS
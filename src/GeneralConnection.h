@@ -24,10 +24,19 @@
 #ifndef ARANGO_CXX_DRIVER_GENERAL_CONNECTION_H
 #define ARANGO_CXX_DRIVER_GENERAL_CONNECTION_H 1
 
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
 #include <fuerte/connection.h>
+#include <fuerte/executor.h>
 #include <fuerte/types.h>
 
 #include "AsioSockets.h"
+#include "CircuitBreaker.h"
+#include "ObjectPools.h"
+#include "ReceiveBuffer.h"
 
 namespace arangodb { namespace fuerte {
 
@@ -38,7 +47,7 @@ class GeneralConnection : public fuerte::Connection {
  public:
   explicit GeneralConnection(EventLoopService& loop,
                              detail::ConnectionConfiguration const&);
-  virtual ~GeneralConnection() = default;
+  virtual ~GeneralConnection();
 
   /// @brief connection state
   Connection::State state() const override final {
@@ -51,7 +60,33 @@ class GeneralConnection : public fuerte::Connection {
   // Activate this connection
   void startConnection() override;
 
+  /// @brief invoke cb once the request queue has space again
+  void notifyOnQueueSpace(std::function<void()> cb) override;
+
+  /// @brief cancel a single request
+  void cancelRequest(MessageID mid) override;
+
+  /// @brief keep the response for reuse on our io_context
+  void recycle(std::unique_ptr<Response> res) override {
+    _pools.responses.release(res.release());
+  }
+
+  /// @brief bytes of responses being received
+  std::size_t bufferedBytes() const override {
+    return _bufferedBytes.load(std::memory_order_relaxed);
+  }
+
  protected:
+  /// @brief fail a request that was never queued, through bindExecutor()
+  void failRequest(Error err, std::unique_ptr<Request> req,
+                   RequestHandler cb) override {
+    bindExecutor(cb);
+    asio_ns::post(*_io_context, [err, req = std::move(req),
+                                 cb = std::move(cb)]() mutable {
+      cb(err, std::move(req), nullptr);
+    });
+  }
+
   // shutdown connection, cancel async operations
   void shutdownConnection(const fuerte::Error, std::string const& msg = "");
 
@@ -63,6 +98,122 @@ class GeneralConnection : public fuerte::Connection {
   // Call on IO-Thread: read from socket
   void asyncReadSome();
 
+  /// Call on IO-Thread: read straight into `target`, i.e. the payload
+  /// buffer, instead of _receiveBuffer. Saves copying large bodies, only
+  /// use while _receiveBuffer is empty. `target` must stay valid until
+  /// asyncReadIntoCallback() is called.
+  void asyncReadInto(asio_ns::mutable_buffer target);
+
+  /// reserve a place in the request queue, false if it is full
+  bool acquireQueueSlot() {
+    uint32_t q = _numQueued.fetch_add(1, std::memory_order_relaxed);
+    if (q >= _config._maxQueuedRequests) {
+      _numQueued.fetch_sub(1, std::memory_order_relaxed);
+      return false;
+    }
+    _loop.addQueued(_ioIndex, 1);
+    return true;
+  }
+
+  /// a response grows to `size` bytes, of which `charged` are accounted
+  /// for already. Checks the maximum response size and the memory budgets
+  /// of the connection and the loop, updates `charged` if it fits.
+  Error reserveResponse(std::size_t& charged, uint64_t size);
+
+  /// the accounted bytes of a response were handed out or dropped
+  void releaseResponse(std::size_t& charged) {
+    _bufferedBytes.fetch_sub(charged, std::memory_order_relaxed);
+    _loop.releaseMemory(charged);
+    charged = 0;
+  }
+
+  /// give back a place in the request queue, wakes up waiting producers.
+  /// Pairs with notifyOnQueueSpace(): each side stores, then loads what
+  /// the other one stores. Only seq_cst keeps both from missing each other.
+  void releaseQueueSlot() {
+    uint32_t q = _numQueued.fetch_sub(1, std::memory_order_seq_cst) - 1;
+    _loop.addQueued(_ioIndex, -1);
+    if (_hasSpaceWaiters.load(std::memory_order_seq_cst) &&
+        q <= _config._maxQueuedRequests / 2) {
+      notifySpaceWaiters();
+    }
+  }
+
+  /// the queue timer fires at `deadline` at the latest, so a request
+  /// waiting in the queue fails at its deadline (thread-safe)
+  void watchDeadline(std::chrono::steady_clock::time_point deadline);
+
+  /// absolute deadline of a request that is handed to us now
+  static std::chrono::steady_clock::time_point requestDeadline(
+      Request const& req) {
+    auto deadline = req.deadline();
+    if (req.timeout().count() > 0) {
+      deadline = std::min(deadline,
+                          std::chrono::steady_clock::now() + req.timeout());
+    }
+    return deadline;
+  }
+
+  /// value of the deadline header: seconds left, millisecond precision
+  static std::string deadlineHeaderValue(
+      std::chrono::steady_clock::time_point deadline) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+    left = std::max<decltype(left)>(left, 0);
+    std::string millis = std::to_string(left % 1000);
+    std::string value = std::to_string(left / 1000);
+    value.append(".").append(3 - millis.size(), '0').append(millis);
+    return value;
+  }
+
+  /// let the configured executor run the callback instead of the IO thread
+  void bindExecutor(RequestHandler& cb) const {
+    if (_config._callbackExecutor) {
+      // allocated up front, keeps the wrapper small enough to be inline
+      auto task = std::make_shared<Completion>();
+      task->cb = std::move(cb);
+      cb = [executor = _config._callbackExecutor, task](
+               Error e, std::unique_ptr<Request> req,
+               std::unique_ptr<Response> res) {
+        task->error = e;
+        task->request = std::move(req);
+        task->response = std::move(res);
+        executor->post([task] {
+          task->cb(task->error, std::move(task->request),
+                   std::move(task->response));
+        });
+      };
+    }
+  }
+
+  /// may a request be sent, `probe` is set for the request that tests
+  /// an open endpoint circuit breaker
+  bool allowRequest(bool& probe) {
+    probe = false;
+    return !_breaker || _breaker->allowRequest(probe);
+  }
+
+  /// report a finished request to the endpoint circuit breaker
+  void reportSuccess(bool probe) {
+    if (_breaker) {
+      _breaker->reportSuccess(probe);
+    }
+  }
+
+  /// a request let through by allowRequest() was not sent after all
+  void releaseProbe(bool probe) {
+    if (_breaker && probe) {
+      _breaker->releaseProbe();
+    }
+  }
+
+  /// report a failed request to the endpoint circuit breaker
+  void reportFailure(bool probe) {
+    if (_breaker) {
+      _breaker->reportFailure(probe);
+    }
+  }
+
  protected:
   virtual void finishConnect() = 0;
 
@@ -72,30 +223,87 @@ class GeneralConnection : public fuerte::Connection {
   // called by the async_read handler (called from IO thread)
   virtual void asyncReadCallback(asio_ns::error_code const&) = 0;
 
+  /// called by the handler of asyncReadInto(), `nread` bytes were placed
+  /// at the start of the target (called from IO thread)
+  virtual void asyncReadIntoCallback(asio_ns::error_code const&,
+                                     std::size_t nread) = 0;
+
   /// abort ongoing / unfinished requests
   virtual void abortOngoingRequests(const fuerte::Error) = 0;
 
   /// abort all requests lingering in the queue
   virtual void drainQueue(const fuerte::Error) = 0;
 
+  /// is the circuit breaker probe among the queued requests (called from
+  /// IO thread)
+  virtual bool probeQueued() = 0;
+
+  /// abort a queued or in-flight request (called from IO thread)
+  /// @return false if the request is done already
+  virtual bool abortRequest(MessageID) = 0;
+
+  /// fail queued requests whose deadline is before `now` with
+  /// Error::Timeout, they stay queued until dequeued (called from IO thread)
+  /// @return the earliest deadline of the remaining queued requests
+  virtual std::chrono::steady_clock::time_point expireQueued(
+      std::chrono::steady_clock::time_point now) = 0;
+
  protected:
+  /// @brief index of our io context in the event loop
+  std::size_t const _ioIndex;
   /// @brief io context to use
   std::shared_ptr<asio_ns::io_context> _io_context;
   /// @brief event loop to use
   EventLoopService& _loop;
+  /// @brief recycled objects of our io_context
+  ObjectPools& _pools;
   /// @brief underlying socket
   std::unique_ptr<Socket<ST>> _proto;
   /// @brief timer to handle connection / request timeouts
   asio_ns::steady_timer _timeout;
+  /// @brief timer for deadlines of queued requests, runs while connecting
+  asio_ns::steady_timer _queueTimeout;
+  /// @brief circuit breaker of our endpoint, may be null
+  std::shared_ptr<CircuitBreaker> _breaker;
 
-  /// default max chunksize is 30kb in arangodb
-  static constexpr size_t READ_BLOCK_SIZE = 1024 * 32;
-  ::asio_ns::streambuf _receiveBuffer;
+  /// received bytes that are not parsed yet
+  ReceiveBuffer _receiveBuffer;
+  /// payload bytes still to come from which on reads go straight into
+  /// the payload buffer, see asyncReadInto()
+  static constexpr std::size_t directReadMinSize = 64 * 1024;
 
   /// @brief is the connection established
   std::atomic<Connection::State> _state;
   
   std::atomic<uint32_t> _numQueued; /// queued items
+  /// bytes of responses being received, see reserveResponse()
+  std::atomic<std::size_t> _bufferedBytes;
+
+ private:
+  /// arguments of a callback handed to the executor
+  struct Completion {
+    RequestHandler cb;
+    Error error;
+    std::unique_ptr<Request> request;
+    std::unique_ptr<Response> response;
+  };
+
+  /// invoke and remove all callbacks waiting for queue space
+  void notifySpaceWaiters();
+
+  /// (re)start _queueTimeout for _queueDeadline (IO-Thread only)
+  void armQueueTimeout();
+
+  std::mutex _spaceMutex;
+  /// producers waiting for space in the request queue
+  std::vector<std::function<void()>> _spaceWaiters;
+  std::atomic<bool> _hasSpaceWaiters;
+
+  /// earliest deadline _queueTimeout is armed for, ticks since the epoch
+  /// of steady_clock. Only lowered by producers until the timer fires.
+  std::atomic<std::chrono::steady_clock::rep> _queueDeadline;
+  static constexpr std::chrono::steady_clock::rep noDeadline =
+      std::chrono::steady_clock::time_point::max().time_since_epoch().count();
 };
 
 }}  // namespace arangodb::fuerte
@@ -48,7 +48,11 @@ int HttpConnection<ST>::on_message_begin(http_parser* parser) {
   self->_lastHeaderWasValue = false;
   self->_shouldKeepAlive = false;
   self->_messageComplete = false;
-  self->_response.reset(new Response());
+  self->_knownBodyLength = false;
+  self->_bodyInPlace = false;
+  self->_responseBuffer.reset();  // nothing of an abandoned response
+  self->_allocatedBody.reset();
+  self->_response.reset(self->_pools.responses.acquire());
   return 0;
 }
 
@@ -111,6 +115,20 @@ int HttpConnection<ST>::on_header_complete(http_parser* parser) {
     return 1;  // tells the parser it should not expect a body
   } else if (parser->content_length > 0 &&
              parser->content_length < ULLONG_MAX) {
+    // content_length counts down the body bytes still to come
+    self->_knownBodyLength = (parser->flags & F_CHUNKED) == 0;
+    if (self->_knownBodyLength) {  // fail before anything is reserved
+      self->_responseError =
+          self->reserveResponse(self->_chargedBytes, parser->content_length);
+      if (self->_responseError != Error::NoError) {
+        return -1;  // stops the parser
+      }
+    }
+    auto const& allocator = self->_item->request->responseAllocator();
+    if (self->_knownBodyLength && allocator &&
+        self->_allocatedBody.allocate(allocator, parser->content_length)) {
+      return 0;  // the body goes straight to the storage of the allocator
+    }
     uint64_t maxReserve = std::min<uint64_t>(2 << 24, parser->content_length);
     self->_responseBuffer.reserve(maxReserve);
   }
@@ -121,8 +139,28 @@ int HttpConnection<ST>::on_header_complete(http_parser* parser) {
 template <SocketType ST>
 int HttpConnection<ST>::on_body(http_parser* parser, const char* at,
                                 size_t len) {
-  static_cast<HttpConnection<ST>*>(parser->data)
-      ->_responseBuffer.append(at, len);
+  HttpConnection<ST>* self = static_cast<HttpConnection<ST>*>(parser->data);
+  if (!self->_knownBodyLength) {  // accounted for as it arrives
+    self->_responseError = self->reserveResponse(
+        self->_chargedBytes, self->_responseBuffer.size() + len);
+    if (self->_responseError != Error::NoError) {
+      return -1;  // stops the parser
+    }
+  }
+  // with _bodyInPlace the bytes were read to their place already
+  if (self->_allocatedBody.active()) {
+    if (self->_bodyInPlace) {
+      self->_allocatedBody.advance(len);
+    } else {
+      self->_allocatedBody.append(at, len);
+    }
+  } else if (self->_bodyInPlace) {
+    assert(reinterpret_cast<uint8_t const*>(at) ==
+           self->_responseBuffer.data() + self->_responseBuffer.size());
+    self->_responseBuffer.advance(len);
+  } else {
+    self->_responseBuffer.append(at, len);
+  }
   return 0;
 }
 
@@ -136,8 +174,9 @@ template <SocketType ST>
 HttpConnection<ST>::HttpConnection(EventLoopService& loop,
                                    ConnectionConfiguration const& config)
     : GeneralConnection<ST>(loop, config),
-      _queue(),
+      _queue(config._priorityWeights),
       _active(false),
+      _item(nullptr, {&this->_pools.httpItems}),
       _lastHeaderWasValue(false),
       _shouldKeepAlive(false),
       _messageComplete(false) {
@@ -179,26 +218,40 @@ HttpConnection<ST>::~HttpConnection() try {
 
 // Start an asynchronous request.
 template <SocketType ST>
-MessageID HttpConnection<ST>::sendRequest(std::unique_ptr<Request> req,
-                                          RequestCallback cb) {
+MessageID HttpConnection<ST>::trySendRequest(std::unique_ptr<Request>& req,
+                                             RequestHandler& cb) {
   static std::atomic<uint64_t> ticketId(1);
 
-  // construct RequestItem
-  auto item = std::make_unique<RequestItem>();
-  // requestItem->_response later
+  // fail fast while the endpoint is known to be down
+  bool probe;
+  if (!this->allowRequest(probe)) {
+    uint64_t mid = ticketId.fetch_add(1, std::memory_order_relaxed);
+    this->failRequest(Error::CircuitOpen, std::move(req), std::move(cb));
+    return mid;
+  }
+
+  if (!this->acquireQueueSlot()) {
+    this->releaseProbe(probe);  // let the next request probe instead
+    return 0;  // caller keeps the request
+  }
+
+  // construct RequestItem, recycled ones keep their header capacity
+  ItemPtr item = this->_pools.httpItems.acquirePtr();
   uint64_t mid = ticketId.fetch_add(1, std::memory_order_relaxed);
-  item->requestHeader = buildRequestBody(*req);
+  item->messageID = mid;
+  item->expires = this->requestDeadline(*req);
+  auto const deadline = item->expires;
+  item->probe = probe;
+  buildRequestBody(*req, item->requestHeader);
+  this->bindExecutor(cb);
   item->callback = std::move(cb);
+  RequestPriority priority = req->priority();
   item->request = std::move(req);
 
-  // Prepare a new request
-  if (!_queue.push(item.get())) {
-    FUERTE_LOG_ERROR << "connection queue capacity exceeded\n";
-    throw std::length_error("connection queue capacity exceeded");
-  }
-  item.release();  // queue owns this now
+  // Prepare a new request, the queue bound is enforced by acquireQueueSlot
+  _queue.push(item.release(), priority);  // queue owns this now
+  this->watchDeadline(deadline);  // fails even if it is never dequeued
 
-  this->_numQueued.fetch_add(1, std::memory_order_relaxed);
   FUERTE_LOG_HTTPTRACE << "queued item: this=" << this << "\n";
 
   // _state.load() after queuing request, to prevent race with connect
@@ -226,7 +279,11 @@ size_t HttpConnection<ST>::requestsLeft() const {
 
 template <SocketType ST>
 void HttpConnection<ST>::finishConnect() {
+  // keep a fresh connection open until the idle timeout, even if
+  // nothing is queued yet (i.e. it was opened ahead of time)
+  _shouldKeepAlive = true;
   this->_state.store(Connection::State::Connected);
+  this->onConnect(Error::NoError);
   startWriting();  // starts writing queue if non-empty
 }
 
@@ -258,11 +315,12 @@ void HttpConnection<ST>::startWriting() {
 // -----------------------------------------------------------------------------
 
 template <SocketType ST>
-std::string HttpConnection<ST>::buildRequestBody(Request const& req) {
+void HttpConnection<ST>::buildRequestBody(Request const& req,
+                                          std::string& header) {
   // build the request header
   assert(req.header.restVerb != RestVerb::Illegal);
 
-  std::string header;
+  header.clear();
   header.reserve(256);  // TODO is there a meaningful size ?
   header.append(fu::to_string(req.header.restVerb));
   header.push_back(' ');
@@ -285,9 +343,10 @@ std::string HttpConnection<ST>::buildRequestBody(Request const& req) {
       if (header.back() != '?') {
         header.push_back('&');
       }
-      http::urlEncode(header, p.first);
+      std::string_view key = p.key();
+      http::urlEncode(header, key.data(), key.size());
       header.push_back('=');
-      http::urlEncode(header, p.second);
+      http::urlEncode(header, p.value);
     }
   }
   header.append(" HTTP/1.1\r\n")
@@ -314,17 +373,17 @@ std::string HttpConnection<ST>::buildRequestBody(Request const& req) {
 
   bool haveAuth = false;
   for (auto const& pair : req.header.meta()) {
-    if (pair.first == fu_content_length_key) {
+    if (pair.id == HeaderId::ContentLength) {
       continue;  // skip content-length header
     }
 
-    if (pair.first == fu_authorization_key) {
+    if (pair.id == HeaderId::Authorization) {
       haveAuth = true;
     }
 
-    header.append(pair.first);
+    header.append(pair.key());
     header.append(": ");
-    header.append(pair.second);
+    header.append(pair.value);
     header.append("\r\n");
   }
 
@@ -341,7 +400,40 @@ std::string HttpConnection<ST>::buildRequestBody(Request const& req) {
     header.append("\r\n");
   }
   // body will be appended seperately
-  return header;
+}
+
+template <SocketType ST>
+RequestItem* HttpConnection<ST>::popQueue() {
+  while (true) {
+    RequestItem* ptr = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(_queueMutex);
+      ptr = _queue.pop();
+    }
+    if (ptr == nullptr) {
+      return nullptr;
+    }
+    if (!ptr->request) {  // failed by expireQueued() already
+      ItemPtr guard(ptr, {&this->_pools.httpItems});
+      this->releaseQueueSlot();
+      continue;
+    }
+    Error err = Error::NoError;
+    if (ptr->canceled) {
+      err = Error::Canceled;  // canceled before it was written
+    } else if (ptr->expires <= std::chrono::steady_clock::now()) {
+      FUERTE_LOG_DEBUG << "HTTP-Request expired in queue\n";
+      if (ptr->probe) {
+        this->reportFailure(true);  // the probe got no answer in time
+      }
+      err = Error::Timeout;  // don't bother the server
+    } else {
+      return ptr;
+    }
+    ItemPtr guard(ptr, {&this->_pools.httpItems});
+    this->releaseQueueSlot();
+    guard->invokeOnError(err);
+  }
 }
 
 // writes data from task queue to network using asio_ns::async_write
@@ -350,12 +442,13 @@ void HttpConnection<ST>::asyncWriteNextRequest() {
   FUERTE_LOG_HTTPTRACE << "asyncWriteNextRequest: this=" << this << "\n";
   assert(_active.load());
 
-  http::RequestItem* ptr = nullptr;
-  if (!_queue.pop(ptr)) {
+  http::RequestItem* ptr = popQueue();
+  if (ptr == nullptr) {
     _active.store(false);
-    if (!_queue.pop(ptr)) {
+    if ((ptr = popQueue()) == nullptr) {
       FUERTE_LOG_HTTPTRACE << "asyncWriteNextRequest: stopped writing, this="
                            << this << "\n";
+      this->_receiveBuffer.release();  // idle, give back the memory
       if (_shouldKeepAlive && this->_config._idleTimeout.count() > 0) {
         FUERTE_LOG_HTTPTRACE << "setting idle keep alive timer, this=" << this
                              << "\n";
@@ -367,21 +460,36 @@ void HttpConnection<ST>::asyncWriteNextRequest() {
     }
     _active.store(true);
   }
-  this->_numQueued.fetch_sub(1, std::memory_order_relaxed);
-
-  std::unique_ptr<http::RequestItem> item(ptr);
-  setTimeout(item->request->timeout());
+  this->releaseQueueSlot();
+
+  ItemPtr item(ptr, {&this->_pools.httpItems});
+  setTimeout(item->expires);
+
+  if (!this->_config._deadlineHeader.empty() &&
+      item->expires != std::chrono::steady_clock::time_point::max()) {
+    // insert before the empty line terminating the header
+    std::string field = this->_config._deadlineHeader;
+    field.append(": ").append(this->deadlineHeaderValue(item->expires));
+    field.append("\r\n");
+    item->requestHeader.insert(item->requestHeader.size() - 2, field);
+  }
 
-  std::array<asio_ns::const_buffer, 2> buffers;
-  buffers[0] =
-      asio_ns::buffer(item->requestHeader.data(), item->requestHeader.size());
+  // header and payload segments go out in one gather write, the payload is
+  // referenced in place
+  item->writeBuffers.clear();
+  item->writeBuffers.emplace_back(item->requestHeader.data(),
+                                  item->requestHeader.size());
   // GET and HEAD have no payload
   if (item->request->header.restVerb != RestVerb::Get &&
       item->request->header.restVerb != RestVerb::Head) {
-    buffers[1] = item->request->payload();
+    item->request->payloadBuffers(item->writeBuffers);
   }
+  http::BufferRange buffers{
+      item->writeBuffers.data(),
+      item->writeBuffers.data() + item->writeBuffers.size()};
 
-  asio_ns::async_write(this->_proto->socket, std::move(buffers),
+  _writeItem = item.get();
+  asio_ns::async_write(this->_proto->socket, buffers,
                        [self(Connection::shared_from_this()),
                         req(std::move(item))](asio_ns::error_code const& ec,
                                               std::size_t nwrite) mutable {
@@ -394,8 +502,9 @@ void HttpConnection<ST>::asyncWriteNextRequest() {
 // called by the async_write handler (called from IO thread)
 template <SocketType ST>
 void HttpConnection<ST>::asyncWriteCallback(asio_ns::error_code const& ec,
-                                            std::unique_ptr<RequestItem> item,
+                                            ItemPtr item,
                                             size_t nwrite) {
+  _writeItem = nullptr;
   if (ec) {
     // Send failed
     FUERTE_LOG_DEBUG << "asyncWriteCallback (http): error '" << ec.message()
@@ -403,9 +512,13 @@ void HttpConnection<ST>::asyncWriteCallback(asio_ns::error_code const& ec,
     
     // keepalive timeout may have expired
     auto err = translateError(ec, Error::WriteError);
-    if (ec == asio_ns::error::broken_pipe && nwrite == 0) { // re-queue
-      sendRequest(std::move(item->request), item->callback);
+    if (ec == asio_ns::error::broken_pipe && nwrite == 0 &&
+        this->acquireQueueSlot()) {  // re-queue, keeps the MessageID
+      RequestPriority priority = item->request->priority();
+      buildRequestBody(*item->request, item->requestHeader);
+      _queue.push(item.release(), priority);
     } else {
+      this->reportFailure(item->probe);
       // let user know that this request caused the error
       item->callback(err, std::move(item->request), nullptr);
     }
@@ -426,7 +539,12 @@ void HttpConnection<ST>::asyncWriteCallback(asio_ns::error_code const& ec,
   assert(_item == nullptr);
   _item = std::move(item);
 
-  setTimeout(_item->request->timeout());      // extend timeout
+  if (_item->canceled) {  // canceled while writing
+    abandonResponse();
+    return;
+  }
+
+  setTimeout(_item->expires);                 // deadline is absolute
   http_parser_init(&_parser, HTTP_RESPONSE);  // reset parser
 
   this->asyncReadSome();  // listen for the response
@@ -442,72 +560,149 @@ void HttpConnection<ST>::asyncReadCallback(asio_ns::error_code const& ec) {
   if (ec) {
     FUERTE_LOG_DEBUG << "asyncReadCallback: Error while reading from socket: '";
 
+    if (_item) {
+      this->reportFailure(_item->probe);
+    }
     // Restart connection, will invoke _item cb
     this->restartConnection(translateError(ec, Error::ReadError));
     return;
   }
 
+  // Inspect the data we've received so far.
+  auto buffer = this->_receiveBuffer.data();  // no copy, contiguous
+  if (!parseResponse(static_cast<const char*>(buffer.data()), buffer.size())) {
+    return;
+  }
+
+  // Remove consumed data from receive buffer.
+  this->_receiveBuffer.consume(buffer.size());
+  processResponse();
+}
+
+// called by the handler of asyncReadInto (called from IO thread)
+template <SocketType ST>
+void HttpConnection<ST>::asyncReadIntoCallback(asio_ns::error_code const& ec,
+                                               std::size_t nread) {
+  if (ec) {
+    asyncReadCallback(ec);
+    return;
+  }
+
+  // the body bytes are in place already, the parser only accounts for them
+  _bodyInPlace = true;
+  char const* data =
+      _allocatedBody.active()
+          ? static_cast<char const*>(_allocatedBody.tail().data())
+          : reinterpret_cast<char const*>(_responseBuffer.data() +
+                                          _responseBuffer.size());
+  bool ok = parseResponse(data, nread);
+  _bodyInPlace = false;
+  if (ok) {
+    processResponse();
+  }
+}
+
+// feeds received bytes to the parser, false if the connection was shut down
+template <SocketType ST>
+bool HttpConnection<ST>::parseResponse(char const* data, std::size_t len) {
   if (!_item) {  // should not happen
     assert(false);
     this->shutdownConnection(Error::Canceled);
-    return;
+    return false;
   }
 
-  // Inspect the data we've received so far.
-  size_t parsedBytes = 0;
-  auto buffers = this->_receiveBuffer.data();  // no copy
-  for (auto const& buffer : buffers) {
-    /* Start up / continue the parser.
-     * Note we pass recved==0 to signal that EOF has been received.
-     */
-    size_t nparsed = http_parser_execute(
-        &_parser, &_parserSettings, static_cast<const char*>(buffer.data()),
-        buffer.size());
-    parsedBytes += nparsed;
-
-    if (_parser.upgrade) {
-      /* handle new protocol */
-      FUERTE_LOG_ERROR << "Upgrading is not supported\n";
-      this->shutdownConnection(Error::ProtocolError);  // will cleanup _item
-      return;
-    } else if (nparsed != buffer.size()) {
-      /* Handle error. Usually just close the connection. */
-      FUERTE_LOG_ERROR << "Invalid HTTP response in parser: '"
-                       << http_errno_description(HTTP_PARSER_ERRNO(&_parser))
-                       << "'\n";
-      this->shutdownConnection(Error::ProtocolError);  // will cleanup _item
-      return;
-    } else if (_messageComplete) {
-      this->_timeout.cancel();  // got response in time
-      // Remove consumed data from receive buffer.
-      this->_receiveBuffer.consume(parsedBytes);
-
-      // thread-safe access on IO-Thread
-      if (!_responseBuffer.empty()) {
-        _response->setPayload(std::move(_responseBuffer), 0);
+  /* Start up / continue the parser.
+   * Note we pass recved==0 to signal that EOF has been received.
+   */
+  size_t nparsed = http_parser_execute(&_parser, &_parserSettings, data, len);
+
+  if (_responseError != Error::NoError) {
+    // over the size limit or the memory budget, the rest of the response
+    // cannot be skipped, so the connection has to go
+    FUERTE_LOG_DEBUG << "response rejected: " << to_string(_responseError)
+                     << ", this=" << this << "\n";
+    Error err = _responseError;
+    _responseError = Error::NoError;
+    this->restartConnection(err);  // will invoke the _item callback
+    return false;
+  } else if (_parser.upgrade) {
+    /* handle new protocol */
+    FUERTE_LOG_ERROR << "Upgrading is not supported\n";
+    this->shutdownConnection(Error::ProtocolError);  // will cleanup _item
+    return false;
+  } else if (nparsed != len) {
+    /* Handle error. Usually just close the connection. */
+    FUERTE_LOG_ERROR << "Invalid HTTP response in parser: '"
+                     << http_errno_description(HTTP_PARSER_ERRNO(&_parser))
+                     << "'\n";
+    this->shutdownConnection(Error::ProtocolError);  // will cleanup _item
+    return false;
+  }
+  return true;
+}
+
+// hands out a complete response, otherwise reads on
+template <SocketType ST>
+void HttpConnection<ST>::processResponse() {
+  if (_messageComplete) {
+    this->_timeout.cancel();  // got response in time
+
+    this->releaseResponse(_chargedBytes);  // handed out now
+
+    // thread-safe access on IO-Thread
+    if (_allocatedBody.active()) {
+      _response->setPayload(_allocatedBody.release());
+    } else if (!_responseBuffer.empty()) {
+      // body of unknown length, moved to the allocator once complete. One
+      // of known length is here only if the allocator declined it already
+      PayloadSlice allocated;
+      auto const& allocator = _item->request->responseAllocator();
+      if (allocator && !_knownBodyLength) {
+        allocated = AllocatedPayload::copy(allocator, _responseBuffer.data(),
+                                           _responseBuffer.size());
       }
-      
-      try {
-        _item->callback(Error::NoError, std::move(_item->request),
-                        std::move(_response));
-      } catch(...) {
-        FUERTE_LOG_ERROR << "unhandled exception in fuerte callback\n";
+      if (allocated.empty()) {
+        // the buffer of a recycled response is used for the next one
+        _response->swapPayload(_responseBuffer, 0);
+      } else {
+        _response->setPayload(std::move(allocated));
+        _responseBuffer.reset();
       }
+    }
+    this->reportSuccess(_item->probe);
 
-      _item.reset();
-      FUERTE_LOG_HTTPTRACE << "asyncReadCallback: completed parsing "
-                              "response this="
-                           << this << "\n";
 
-      asyncWriteNextRequest();  // send next request
-      return;
+    try {
+      _item->callback(Error::NoError, std::move(_item->request),
+                      std::move(_response));
+    } catch(...) {
+      FUERTE_LOG_ERROR << "unhandled exception in fuerte callback\n";
     }
-  }
 
-  // Remove consumed data from receive buffer.
-  this->_receiveBuffer.consume(parsedBytes);
+    _item.reset();
+    FUERTE_LOG_HTTPTRACE << "asyncReadCallback: completed parsing "
+                            "response this="
+                         << this << "\n";
+
+    asyncWriteNextRequest();  // send next request
+    return;
+  }
 
   FUERTE_LOG_HTTPTRACE << "asyncReadCallback: response not complete yet\n";
+  // the rest of a large body of known length is read in place, the
+  // receive buffer is empty here since the parser takes all bytes
+  if (_knownBodyLength &&
+      _parser.content_length >= GeneralConnection<ST>::directReadMinSize) {
+    if (_allocatedBody.active()) {
+      this->asyncReadInto(_allocatedBody.tail());
+      return;
+    }
+    std::size_t len = std::min<uint64_t>(2 << 24, _parser.content_length);
+    _responseBuffer.reserve(len);
+    this->asyncReadInto(asio_ns::mutable_buffer(
+        _responseBuffer.data() + _responseBuffer.size(), len));
+    return;
+  }
   this->asyncReadSome();  // keep reading from socket
 }
 
@@ -518,9 +713,19 @@ void HttpConnection<ST>::setTimeout(std::chrono::milliseconds millis) {
     this->_timeout.cancel();
     return;
   }
+  setTimeout(std::chrono::steady_clock::now() + millis);
+}
+
+template <SocketType ST>
+void HttpConnection<ST>::setTimeout(
+    std::chrono::steady_clock::time_point expires) {
+  if (expires == std::chrono::steady_clock::time_point::max()) {
+    this->_timeout.cancel();
+    return;
+  }
 
-  // expires_after cancels pending ops
-  this->_timeout.expires_after(millis);
+  // expires_at cancels pending ops
+  this->_timeout.expires_at(expires);
   this->_timeout.async_wait([self = Connection::weak_from_this()](auto const& ec) {
     std::shared_ptr<Connection> s;
     if (ec || !(s = self.lock())) {  // was canceled / deallocated
@@ -530,6 +735,9 @@ void HttpConnection<ST>::setTimeout(std::chrono::milliseconds millis) {
 
     FUERTE_LOG_DEBUG << "HTTP-Request timeout\n";
     if (thisPtr->_active) {
+      RequestItem const* item =
+          thisPtr->_item ? thisPtr->_item.get() : thisPtr->_writeItem;
+      thisPtr->reportFailure(item != nullptr && item->probe);
       thisPtr->restartConnection(Error::Timeout);
     } else {  // close an idle connection
       thisPtr->shutdownConnection(Error::CloseRequested);
@@ -542,6 +750,11 @@ template <SocketType ST>
 void HttpConnection<ST>::abortOngoingRequests(const fuerte::Error ec) {
   // simon: thread-safe, only called from IO-Thread
   // (which holds shared_ptr) and destructors
+  // drop what was received of the response, before the callback can see
+  // the memory still in use
+  _responseBuffer.clear();
+  _allocatedBody.reset();
+  this->releaseResponse(_chargedBytes);
   if (_item) {
     // Item has failed, remove from message store
     _item->invokeOnError(ec);
@@ -550,15 +763,91 @@ void HttpConnection<ST>::abortOngoingRequests(const fuerte::Error ec) {
   _active.store(false);  // no IO operations running
 }
 
+/// abandon the in-flight request
+template <SocketType ST>
+bool HttpConnection<ST>::abortRequest(MessageID mid) {
+  if (_item && _item->messageID == mid) {
+    abandonResponse();
+    return true;
+  }
+  if (_writeItem && _writeItem->messageID == mid) {
+    _writeItem->canceled = true;  // abandoned once written
+    return true;
+  }
+  std::lock_guard<std::mutex> guard(_queueMutex);
+  RequestItem* item = _queue.find(
+      [mid](RequestItem const* i) { return i->messageID == mid; });
+  if (item == nullptr) {
+    return false;  // done already
+  }
+  item->canceled = true;  // skipped by popQueue()
+  return true;
+}
+
+template <SocketType ST>
+void HttpConnection<ST>::abandonResponse() {
+  // HTTP/1.1 cannot skip a response, the connection has to go
+  FUERTE_LOG_DEBUG << "abandoning response, this=" << this << "\n";
+  this->restartConnection(Error::Canceled);  // invokes the _item callback
+  if (requestsLeft() > 0) {
+    this->startConnection();
+  }
+}
+
+template <SocketType ST>
+bool HttpConnection<ST>::probeQueued() {
+  std::lock_guard<std::mutex> guard(_queueMutex);
+  return _queue.find([](RequestItem const* i) {
+           return i->probe && i->request;
+         }) != nullptr;
+}
+
 /// abort all requests lingering in the queue
 template <SocketType ST>
 void HttpConnection<ST>::drainQueue(const fuerte::Error ec) {
-  RequestItem* item = nullptr;
-  while (_queue.pop(item)) {
-    std::unique_ptr<RequestItem> guard(item);
-    this->_numQueued.fetch_sub(1, std::memory_order_relaxed);
-    guard->invokeOnError(ec);
+  std::vector<ItemPtr> items;
+  {  // take everything at once, callbacks may queue new requests
+    std::lock_guard<std::mutex> guard(_queueMutex);
+    _queue.drain([&](RequestItem* item) {
+      items.emplace_back(item, ItemPtr::deleter_type{&this->_pools.httpItems});
+    });
+  }
+  for (auto& item : items) {
+    this->releaseQueueSlot();
+    if (item->request) {  // not failed by expireQueued() already
+      item->invokeOnError(ec);
+    }
+  }
+}
+
+template <SocketType ST>
+std::chrono::steady_clock::time_point HttpConnection<ST>::expireQueued(
+    std::chrono::steady_clock::time_point now) {
+  std::vector<std::pair<RequestHandler, std::unique_ptr<Request>>> expired;
+  auto next = std::chrono::steady_clock::time_point::max();
+  {
+    std::lock_guard<std::mutex> guard(_queueMutex);
+    _queue.find([&](RequestItem* item) {
+      if (!item->request || item->canceled) {
+        return false;  // failed already or fails once dequeued
+      }
+      if (item->expires <= now) {  // the husk is skipped by popQueue()
+        if (item->probe) {
+          this->reportFailure(true);  // the probe got no answer in time
+        }
+        expired.emplace_back(std::move(item->callback),
+                             std::move(item->request));
+      } else {
+        next = std::min(next, item->expires);
+      }
+      return false;  // visit every item
+    });
+  }
+  for (auto& pair : expired) {  // callbacks may queue new requests
+    FUERTE_LOG_DEBUG << "HTTP-Request expired in queue\n";
+    pair.first(Error::Timeout, std::move(pair.second), nullptr);
   }
+  return next;
 }
 
 template class arangodb::fuerte::v1::http::HttpConnection<SocketType::Tcp>;
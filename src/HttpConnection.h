@@ -25,14 +25,16 @@
 
 #include <atomic>
 #include <chrono>
-
-#include <boost/lockfree/queue.hpp>
+#include <mutex>
 
 #include <fuerte/helper.h>
 #include <fuerte/loop.h>
 #include <fuerte/message.h>
 
+#include "AllocatedPayload.h"
 #include "GeneralConnection.h"
+#include "ObjectPools.h"
+#include "PriorityQueue.h"
 
 #include "http.h"
 #include "http_parser/http_parser.h"
@@ -49,7 +51,8 @@ class HttpConnection final : public fuerte::GeneralConnection<ST> {
 
  public:
   /// Start an asynchronous request.
-  MessageID sendRequest(std::unique_ptr<Request>, RequestCallback) override;
+  MessageID trySendRequest(std::unique_ptr<Request>&,
+                           RequestHandler&) override;
 
   /// @brief Return the number of requests that have not yet finished.
   size_t requestsLeft() const override;
@@ -63,27 +66,58 @@ class HttpConnection final : public fuerte::GeneralConnection<ST> {
   // called by the async_read handler (called from IO thread)
   void asyncReadCallback(asio_ns::error_code const&) override;
 
+  // called by the handler of asyncReadInto (called from IO thread)
+  void asyncReadIntoCallback(asio_ns::error_code const&,
+                             std::size_t nread) override;
+
   /// abort ongoing / unfinished requests
   void abortOngoingRequests(const fuerte::Error) override;
 
   /// abort all requests lingering in the queue
   void drainQueue(const fuerte::Error) override;
 
+  /// is the circuit breaker probe among the queued requests
+  bool probeQueued() override;
+
+  /// skip a queued request, abandon a written one
+  bool abortRequest(MessageID) override;
+
+  /// fail queued requests past their deadline
+  std::chrono::steady_clock::time_point expireQueued(
+      std::chrono::steady_clock::time_point now) override;
+
  private:
-  // build request body for given request
-  std::string buildRequestBody(Request const& req);
+  /// request item that goes back into the pool of our io_context
+  using ItemPtr = ObjectPool<RequestItem>::Ptr;
+
+  // build request header for given request into `header`
+  void buildRequestBody(Request const& req, std::string& header);
 
   /// set the timer accordingly
   void setTimeout(std::chrono::milliseconds);
+  void setTimeout(std::chrono::steady_clock::time_point);
+
+  /// take the next queued request, skips canceled ones (IO-Thread only)
+  RequestItem* popQueue();
+
+  /// close the connection to abandon the response of the in-flight
+  /// request, reconnects if more requests are queued
+  void abandonResponse();
 
   ///  Call on IO-Thread: writes out one queued request
   void asyncWriteNextRequest();
 
   // called by the async_write handler (called from IO thread)
-  void asyncWriteCallback(asio_ns::error_code const&,
-                          std::unique_ptr<RequestItem>,
+  void asyncWriteCallback(asio_ns::error_code const&, ItemPtr,
                           size_t nwrite);
 
+  /// feed received bytes to the parser, false if the connection was
+  /// shut down because of them
+  bool parseResponse(char const* data, std::size_t len);
+
+  /// hand out a complete response, otherwise continue reading
+  void processResponse();
+
  private:
   static int on_message_begin(http_parser* parser);
   static int on_status(http_parser* parser, const char* at, size_t len);
@@ -94,10 +128,10 @@ class HttpConnection final : public fuerte::GeneralConnection<ST> {
   static int on_message_complete(http_parser* parser);
 
  private:
-  /// elements to send out
-  boost::lockfree::queue<fuerte::v1::http::RequestItem*,
-                         boost::lockfree::capacity<1024>>
-      _queue;
+  /// elements to send out, by priority
+  PriorityQueue<RequestItem> _queue;
+  /// serializes consumers of _queue, producers never take it
+  std::mutex _queueMutex;
 
   /// cached authentication header
   std::string _authHeader;
@@ -114,15 +148,29 @@ class HttpConnection final : public fuerte::GeneralConnection<ST> {
 
   /// response buffer, moved after writing
   velocypack::Buffer<uint8_t> _responseBuffer;
+  /// response body in storage of the request's PayloadAllocator, used
+  /// instead of _responseBuffer if the length is known
+  AllocatedPayload _allocatedBody;
 
+  /// request item being written, owned by the write handler
+  RequestItem* _writeItem = nullptr;
   /// currently in-flight request item
-  std::unique_ptr<RequestItem> _item;
+  ItemPtr _item;
   /// response data, may be null before response header is received
   std::unique_ptr<arangodb::fuerte::v1::Response> _response;
 
   bool _lastHeaderWasValue = false;
   bool _shouldKeepAlive = false;
   bool _messageComplete = false;
+  /// body length is known from Content-Length, large bodies are read
+  /// straight into _responseBuffer
+  bool _knownBodyLength = false;
+  /// bytes handed to the parser are in _responseBuffer already
+  bool _bodyInPlace = false;
+  /// response bytes accounted for, see reserveResponse()
+  std::size_t _chargedBytes = 0;
+  /// set by parser callbacks if the response exceeds a limit
+  Error _responseError = Error::NoError;
 };
 }}}}  // namespace arangodb::fuerte::v1::http
 
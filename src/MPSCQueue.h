@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_MPSC_QUEUE_H
+#define ARANGO_CXX_DRIVER_MPSC_QUEUE_H 1
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief link field of items stored in a MPSCQueue, queued types
+/// must derive from it. An item can only be in one queue at a time.
+struct MPSCQueueHook {
+  std::atomic<MPSCQueueHook*> _next{nullptr};
+};
+
+/// @brief Unbounded intrusive multi-producer single-consumer queue after
+/// Dmitry Vyukov. push() is wait-free: a single atomic exchange, no CAS
+/// loop, no allocation. pop() uses plain loads on the consumer side.
+///
+/// Only one thread may pop() / drain() at a time. A push that has swapped
+/// the head but not yet linked its item is not visible to pop(), so
+/// producers must wake the consumer after push() returns. drain() waits
+/// for such pushes instead.
+///
+/// The queue does not own its items, drain it before destruction.
+template <typename T>
+class MPSCQueue {
+ public:
+  MPSCQueue() : _head(&_stub), _tail(&_stub) {}
+
+  MPSCQueue(MPSCQueue const&) = delete;
+  MPSCQueue& operator=(MPSCQueue const&) = delete;
+
+  /// @brief append an item, thread-safe and wait-free
+  void push(T* item) { pushHook(item); }
+
+  /// @brief remove the oldest item, consumer only
+  /// @return nullptr if no linked item is available
+  T* pop() {
+    MPSCQueueHook* tail = _tail;
+    MPSCQueueHook* next = tail->_next.load(std::memory_order_acquire);
+    if (tail == &_stub) {
+      if (next == nullptr) {
+        return nullptr;
+      }
+      _tail = next;  // skip the stub
+      tail = next;
+      next = next->_next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+      _tail = next;
+      return static_cast<T*>(tail);
+    }
+    if (tail != _head.load(std::memory_order_acquire)) {
+      return nullptr;  // a producer has not linked its item yet
+    }
+    // tail is the last item, put the stub behind it so we can take it
+    pushHook(&_stub);
+    next = tail->_next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      _tail = next;
+      return static_cast<T*>(tail);
+    }
+    return nullptr;
+  }
+
+  /// @brief take every item pushed before the call and hand them to `f`
+  /// in order, consumer only. Waits for producers that swapped the head
+  /// but did not link their item yet, later pushes stay in the queue.
+  /// @return number of items taken
+  template <typename F>
+  std::size_t drain(F&& f) {
+    MPSCQueueHook* const last = _head.load(std::memory_order_acquire);
+    MPSCQueueHook* node = _tail;
+    std::size_t n = 0;
+    while (true) {
+      bool const isLast = node == last;
+      if (isLast) {
+        if (node == &_stub) {
+          break;  // all taken, the stub is the tail again
+        }
+        pushHook(&_stub);  // the last item needs a successor to be taken
+      }
+      MPSCQueueHook* next = waitForNext(node);  // before `f` reuses node
+      if (node != &_stub) {
+        f(static_cast<T*>(node));
+        n++;
+      }
+      node = next;
+      if (isLast) {
+        break;
+      }
+    }
+    _tail = node;
+    return n;
+  }
+
+  /// @brief first item pushed before the call for which `pred` is true,
+  /// consumer only. The item stays queued.
+  template <typename P>
+  T* find(P&& pred) {
+    MPSCQueueHook* const last = _head.load(std::memory_order_acquire);
+    for (MPSCQueueHook* node = _tail;; node = waitForNext(node)) {
+      if (node != &_stub && pred(static_cast<T*>(node))) {
+        return static_cast<T*>(node);
+      }
+      if (node == last) {
+        return nullptr;
+      }
+    }
+  }
+
+  /// @brief true if pop() would not return an item, consumer only
+  bool empty() const {
+    MPSCQueueHook const* tail = _tail;
+    MPSCQueueHook const* next = tail->_next.load(std::memory_order_acquire);
+    if (tail == &_stub) {
+      if (next == nullptr) {
+        return true;
+      }
+      tail = next;
+      next = next->_next.load(std::memory_order_acquire);
+    }
+    return next == nullptr && tail != _head.load(std::memory_order_acquire);
+  }
+
+ private:
+  void pushHook(MPSCQueueHook* node) {
+    node->_next.store(nullptr, std::memory_order_relaxed);
+    MPSCQueueHook* prev = _head.exchange(node, std::memory_order_acq_rel);
+    prev->_next.store(node, std::memory_order_release);
+  }
+
+  /// successor of a node that is not the head, its producer may still be
+  /// about to link it
+  static MPSCQueueHook* waitForNext(MPSCQueueHook* node) {
+    MPSCQueueHook* next;
+    while ((next = node->_next.load(std::memory_order_acquire)) == nullptr) {
+      std::this_thread::yield();
+    }
+    return next;
+  }
+
+ private:
+  /// producers swap themselves in here
+  alignas(64) std::atomic<MPSCQueueHook*> _head;
+  /// consumer side, kept on its own cache line
+  alignas(64) MPSCQueueHook* _tail;
+  MPSCQueueHook _stub;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_OBJECT_POOL_H
+#define ARANGO_CXX_DRIVER_OBJECT_POOL_H 1
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief Bounded free list of objects, so their memory (and the capacity
+/// of their buffers) is reused instead of going back to the allocator.
+/// Thread-safe, but never blocks: if another thread holds the list we
+/// simply allocate or free as usual.
+///
+/// Kept objects are cleared by a `poolReset(T&)` overload found through
+/// argument dependent lookup, it must drop all references but should keep
+/// buffer capacity. The pool must outlive all Ptr obtained from it.
+template <typename T>
+class ObjectPool {
+ public:
+  /// deleter of PoolPtr, puts the object back into its pool
+  struct Recycler {
+    ObjectPool* pool = nullptr;
+    void operator()(T* obj) const {
+      if (pool != nullptr) {
+        pool->release(obj);
+      } else {
+        delete obj;
+      }
+    }
+  };
+  using Ptr = std::unique_ptr<T, Recycler>;
+
+  explicit ObjectPool(std::size_t capacity = 256) : _capacity(capacity) {}
+  ObjectPool(ObjectPool const&) = delete;
+  ObjectPool& operator=(ObjectPool const&) = delete;
+
+  ~ObjectPool() {
+    for (T* obj : _free) {
+      delete obj;
+    }
+  }
+
+  /// @brief a recycled object or a new default constructed one
+  T* acquire() {
+    if (_mutex.try_lock()) {
+      T* obj = nullptr;
+      if (!_free.empty()) {
+        obj = _free.back();
+        _free.pop_back();
+      }
+      _mutex.unlock();
+      if (obj != nullptr) {
+        return obj;
+      }
+    }
+    return new T();
+  }
+
+  /// @brief acquire(), owned by a pointer that releases into this pool
+  Ptr acquirePtr() { return Ptr(acquire(), Recycler{this}); }
+
+  /// @brief keep `obj` for reuse, or delete it if the pool is full
+  void release(T* obj) {
+    if (obj == nullptr) {
+      return;
+    }
+    poolReset(*obj);  // runs destructors of its members, not under the lock
+    if (_mutex.try_lock()) {
+      if (_free.size() < _capacity) {
+        if (_free.capacity() == 0) {
+          _free.reserve(_capacity);
+        }
+        _free.push_back(obj);
+        obj = nullptr;
+      }
+      _mutex.unlock();
+    }
+    delete obj;  // no-op if kept
+  }
+
+  /// @brief number of objects ready for reuse
+  std::size_t size() {
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _free.size();
+  }
+
+ private:
+  std::mutex _mutex;
+  std::vector<T*> _free;
+  std::size_t const _capacity;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
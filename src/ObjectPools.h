@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_OBJECT_POOLS_H
+#define ARANGO_CXX_DRIVER_OBJECT_POOLS_H 1
+
+#include <fuerte/message.h>
+
+#include "ObjectPool.h"
+#include "http.h"
+#include "vst.h"
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief drop header and payload of a response kept for reuse. The
+/// payload buffer keeps its capacity unless it is large, connections hand
+/// it back to their receive path through Response::swapPayload()
+inline void poolReset(Response& res) {
+  res.header = ResponseHeader();
+  res.clearPayload(1024 * 1024);
+}
+
+/// @brief recycled objects of the connections on one io_context,
+/// see EventLoopService::objectPools()
+struct ObjectPools {
+  ObjectPool<http::RequestItem> httpItems;
+  ObjectPool<vst::RequestItem> vstItems;
+  ObjectPool<Response> responses;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
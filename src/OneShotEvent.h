@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_ONE_SHOT_EVENT_H
+#define ARANGO_CXX_DRIVER_ONE_SHOT_EVENT_H 1
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief One waiter blocks until one other thread calls set(). On Linux
+/// this is a single 32 bit word and a futex, the waiter only enters the
+/// kernel if set() has not happened yet. Other platforms fall back to a
+/// mutex and condition variable. No allocation, may live on the stack of
+/// the waiter.
+class OneShotEvent {
+ public:
+  OneShotEvent() : _state(Initial) {}
+  OneShotEvent(OneShotEvent const&) = delete;
+  OneShotEvent& operator=(OneShotEvent const&) = delete;
+
+#ifdef __linux__
+  void set() {
+    if (_state.exchange(Set, std::memory_order_acq_rel) == Waiting) {
+      // the waiter may be gone already, a futex wake on its former stack
+      // address at most causes a spurious wakeup elsewhere
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_state),
+              FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+  }
+
+  void wait() {
+    uint32_t s = Initial;
+    if (!_state.compare_exchange_strong(s, Waiting,
+                                        std::memory_order_acq_rel) &&
+        s == Set) {
+      return;  // fast path, no syscall
+    }
+    while (_state.load(std::memory_order_acquire) != Set) {
+      // returns right away if the state is not `Waiting` anymore
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_state),
+              FUTEX_WAIT_PRIVATE, Waiting, nullptr, nullptr, 0);
+    }
+  }
+#else
+  // the waiter must not return before set() is done with the mutex
+  void set() {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _state.store(Set, std::memory_order_release);
+    _cv.notify_one();
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> guard(_mutex);
+    _cv.wait(guard, [this] {
+      return _state.load(std::memory_order_acquire) == Set;
+    });
+  }
+#endif
+
+ private:
+  enum : uint32_t { Initial = 0, Set = 1, Waiting = 2 };
+
+  std::atomic<uint32_t> _state;
+#ifndef __linux__
+  std::mutex _mutex;
+  std::condition_variable _cv;
+#endif
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                "futex needs a plain 32 bit word");
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
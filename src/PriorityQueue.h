@@ -0,0 +1,188 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_PRIORITY_QUEUE_H
+#define ARANGO_CXX_DRIVER_PRIORITY_QUEUE_H 1
+
+#include <algorithm>
+#include <array>
+
+#include <fuerte/types.h>
+
+#include "MPSCQueue.h"
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief One MPSCQueue per RequestPriority, served by weighted round
+/// robin: each round the consumer takes up to `weight` items of a class,
+/// always preferring the highest class that still has budget left. Low
+/// priority requests are delayed, but never starved.
+///
+/// The consumer does not pop the MPSCQueues item by item: whenever the
+/// batch of a class runs empty, it drains everything queued for that class
+/// at once and serves the following pops from the batch.
+///
+/// Same threading rules as MPSCQueue: push() from any thread, everything
+/// else only from one consumer at a time.
+template <typename T>
+class PriorityQueue {
+ public:
+  using Weights = std::array<uint32_t, numRequestPriorities>;
+
+  explicit PriorityQueue(Weights const& weights) {
+    for (std::size_t i = 0; i < numRequestPriorities; i++) {
+      _weights[i] = std::max<uint32_t>(weights[i], 1);
+    }
+    _budget = _weights;
+  }
+
+  /// @brief append an item, thread-safe and wait-free
+  void push(T* item, RequestPriority p) {
+    _queues[static_cast<std::size_t>(p)].push(item);
+  }
+
+  /// @brief remove the next item, consumer only
+  T* pop() {
+    for (int round = 0; round < 2; round++) {
+      for (std::size_t i = 0; i < numRequestPriorities; i++) {
+        if (_budget[i] > 0) {
+          T* item = take(i);
+          if (item != nullptr) {
+            _budget[i]--;
+            return item;
+          }
+        }
+      }
+      // every class is either empty or out of budget
+      _budget = _weights;
+    }
+    return nullptr;
+  }
+
+  /// @brief remove an item of a class strictly above `p`, consumer only.
+  /// Does not count against the round budget.
+  T* popAbove(RequestPriority p) {
+    for (std::size_t i = 0; i < static_cast<std::size_t>(p); i++) {
+      T* item = take(i);
+      if (item != nullptr) {
+        return item;
+      }
+    }
+    return nullptr;
+  }
+
+  /// @brief pop all available items and hand them to `f`, consumer only
+  template <typename F>
+  std::size_t drain(F&& f) {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < numRequestPriorities; i++) {
+      while (T* item = _batches[i].take()) {
+        f(item);
+        n++;
+      }
+      n += _queues[i].drain(f);
+    }
+    return n;
+  }
+
+  /// @brief a queued item for which `pred` is true, consumer only
+  template <typename P>
+  T* find(P&& pred) {
+    for (std::size_t i = 0; i < numRequestPriorities; i++) {
+      if (T* item = _batches[i].find(pred)) {
+        return item;
+      }
+      if (T* item = _queues[i].find(pred)) {
+        return item;
+      }
+    }
+    return nullptr;
+  }
+
+  /// @brief true if pop() would not return an item, consumer only
+  bool empty() const {
+    for (std::size_t i = 0; i < numRequestPriorities; i++) {
+      if (_batches[i].head != nullptr || !_queues[i].empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  /// FIFO of drained items, linked through their (now unused) queue hook
+  struct Batch {
+    MPSCQueueHook* head = nullptr;
+    MPSCQueueHook* tail = nullptr;
+
+    void append(T* item) {
+      item->_next.store(nullptr, std::memory_order_relaxed);
+      if (tail == nullptr) {
+        head = item;
+      } else {
+        tail->_next.store(item, std::memory_order_relaxed);
+      }
+      tail = item;
+    }
+
+    T* take() {
+      MPSCQueueHook* node = head;
+      if (node != nullptr) {
+        head = node->_next.load(std::memory_order_relaxed);
+        if (head == nullptr) {
+          tail = nullptr;
+        }
+      }
+      return static_cast<T*>(node);
+    }
+
+    template <typename P>
+    T* find(P&& pred) {
+      for (MPSCQueueHook* node = head; node != nullptr;
+           node = node->_next.load(std::memory_order_relaxed)) {
+        if (pred(static_cast<T*>(node))) {
+          return static_cast<T*>(node);
+        }
+      }
+      return nullptr;
+    }
+  };
+
+  /// next item of class `i`, refills its batch in one drain when empty
+  T* take(std::size_t i) {
+    Batch& batch = _batches[i];
+    if (batch.head == nullptr) {
+      _queues[i].drain([&batch](T* item) { batch.append(item); });
+    }
+    return batch.take();
+  }
+
+ private:
+  std::array<MPSCQueue<T>, numRequestPriorities> _queues;
+  /// consumer side, items already taken from _queues
+  std::array<Batch, numRequestPriorities> _batches;
+  Weights _weights;
+  /// items each class may still send in the current round
+  Weights _budget;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
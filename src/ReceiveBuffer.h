@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_RECEIVE_BUFFER_H
+#define ARANGO_CXX_DRIVER_RECEIVE_BUFFER_H 1
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include <fuerte/asio_ns.h>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief Contiguous receive buffer of a connection. Unparsed bytes
+/// always form one block, so parsers can work on a plain pointer.
+/// Consumed space at the front is reclaimed by moving the (usually
+/// small) unparsed tail down instead of reallocating.
+///
+/// The size of the next read adapts to what the socket delivers: reads
+/// that fill the offered space double it, a run of small reads halves it.
+/// release() gives the memory back while the connection is idle.
+/// Between prepare() and commit() a read is pending: its space is never
+/// moved or freed, and bytes of a read pending during clear() are dropped.
+///
+/// Not thread-safe, only used on the IO thread.
+class ReceiveBuffer {
+ public:
+  static constexpr std::size_t minReadSize = 4 * 1024;
+  static constexpr std::size_t initialReadSize = 32 * 1024;
+  static constexpr std::size_t maxReadSize = 1024 * 1024;
+
+  ReceiveBuffer()
+      : _capacity(0), _head(0), _tail(0), _readSize(initialReadSize),
+        _smallReads(0), _reading(false), _stale(false) {}
+  ReceiveBuffer(ReceiveBuffer const&) = delete;
+  ReceiveBuffer& operator=(ReceiveBuffer const&) = delete;
+
+  /// @brief space for the next read, invalidated by the next prepare()
+  asio_ns::mutable_buffer prepare() {
+    assert(!_reading);
+    _reading = true;
+    if (_capacity - _tail < _readSize) {
+      std::size_t const used = _tail - _head;
+      if (_capacity - used >= _readSize) {
+        // enough room once the front is reclaimed
+        std::memmove(_data.get(), _data.get() + _head, used);
+      } else {
+        std::size_t cap = std::max(_capacity, initialReadSize);
+        while (cap - used < _readSize) {
+          cap *= 2;
+        }
+        std::unique_ptr<uint8_t[]> data(new uint8_t[cap]);
+        if (used > 0) {
+          std::memcpy(data.get(), _data.get() + _head, used);
+        }
+        _data = std::move(data);
+        _capacity = cap;
+      }
+      _head = 0;
+      _tail = used;
+    }
+    return asio_ns::mutable_buffer(_data.get() + _tail, _readSize);
+  }
+
+  /// @brief `n` bytes were read into the space of prepare()
+  void commit(std::size_t n) {
+    assert(_reading && _tail + n <= _capacity);
+    _reading = false;
+    if (_stale) {  // read was started before clear()
+      _stale = false;
+      _head = _tail = 0;
+      return;
+    }
+    _tail += n;
+    if (n == _readSize) {  // more is likely waiting in the socket
+      _readSize = std::min(_readSize * 2, maxReadSize);
+      _smallReads = 0;
+    } else if (n < _readSize / 4 && ++_smallReads >= 8) {
+      _readSize = std::max(_readSize / 2, minReadSize);
+      _smallReads = 0;
+    }
+  }
+
+  /// @brief unparsed bytes, one contiguous block
+  asio_ns::const_buffer data() const {
+    return asio_ns::const_buffer(_data.get() + _head, _tail - _head);
+  }
+
+  std::size_t size() const { return _tail - _head; }
+
+  /// @brief drop `n` parsed bytes from the front
+  void consume(std::size_t n) {
+    assert(n <= size());
+    _head += n;
+    if (_head == _tail) {  // everything parsed, start over at the front
+      _head = _tail = 0;
+    }
+  }
+
+  /// @brief drop all unparsed bytes and those of a pending read
+  void clear() {
+    if (_reading) {  // keep the space of the read, commit() drops it
+      _head = _tail;
+      _stale = true;
+    } else {
+      _head = _tail = 0;
+    }
+  }
+
+  /// @brief free the memory if no unparsed bytes are left and no read is
+  /// pending, call when the connection goes idle. The next prepare()
+  /// allocates again.
+  void release() {
+    if (_head == _tail && !_reading) {
+      _data.reset();
+      _capacity = _head = _tail = 0;
+      _readSize = initialReadSize;
+      _smallReads = 0;
+    }
+  }
+
+  /// @brief bytes currently allocated
+  std::size_t capacity() const { return _capacity; }
+
+  /// @brief size of the next read
+  std::size_t readSize() const { return _readSize; }
+
+ private:
+  std::unique_ptr<uint8_t[]> _data;
+  std::size_t _capacity;
+  /// start of the unparsed bytes
+  std::size_t _head;
+  /// end of the unparsed bytes, the next read goes here
+  std::size_t _tail;
+  std::size_t _readSize;
+  /// consecutive reads that used less than a quarter of the space
+  uint32_t _smallReads;
+  /// a read into the space of prepare() is pending
+  bool _reading;
+  /// the pending read was started before clear()
+  bool _stale;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ResolverCache.h"
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+namespace {
+std::string cacheKey(std::string const& host, std::string const& port) {
+  std::string key;
+  key.reserve(host.size() + port.size() + 1);
+  key.append(host).push_back(':');
+  key.append(port);
+  return key;
+}
+}  // namespace
+
+bool ResolverCache::lookup(std::string const& host, std::string const& port,
+                           std::chrono::milliseconds ttl,
+                           std::chrono::milliseconds negativeTtl,
+                           Endpoints& endpoints, asio_ns::error_code& ec) {
+  std::string key = cacheKey(host, port);
+  auto now = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> guard(_mutex);
+  auto it = _entries.find(key);
+  if (it == _entries.end()) {
+    return false;
+  }
+  // connections may use different ttls, an entry that is stale for one
+  // of them may still be fresh for another
+  Entry const& e = it->second;
+  if (e.resolved + (e.ec ? negativeTtl : ttl) <= now) {
+    return false;
+  }
+  endpoints = e.endpoints;
+  ec = e.ec;
+  return true;
+}
+
+void ResolverCache::store(std::string const& host, std::string const& port,
+                          Endpoints endpoints, asio_ns::error_code const& ec) {
+  if (ec == asio_ns::error::operation_aborted) {
+    return;  // lookup was canceled locally
+  }
+  std::string key = cacheKey(host, port);
+  auto resolved = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> guard(_mutex);
+  Entry& e = _entries[std::move(key)];
+  e.endpoints = std::move(endpoints);
+  e.ec = ec;
+  e.resolved = resolved;
+}
+
+void ResolverCache::invalidate(std::string const& host,
+                               std::string const& port) {
+  std::string key = cacheKey(host, port);
+  std::lock_guard<std::mutex> guard(_mutex);
+  _entries.erase(key);
+}
+
+}}}  // namespace arangodb::fuerte::v1
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_RESOLVER_CACHE_H
+#define ARANGO_CXX_DRIVER_RESOLVER_CACHE_H 1
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fuerte/asio_ns.h>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief ResolverCache keeps the results of recent host name lookups,
+/// shared by all connections of an EventLoopService. Failed lookups are
+/// cached as well (negative caching), so reconnect storms against a dead
+/// host do not hammer the system resolver.
+class ResolverCache {
+ public:
+  using Endpoints = std::vector<asio_ns::ip::tcp::endpoint>;
+
+  /// @brief lookup a cached resolve result, thread-safe. Entries expire
+  /// by the ttls of the caller, `ttl` for endpoints and `negativeTtl` for
+  /// failed lookups, counted from the time they were resolved. A ttl of
+  /// 0 never hits.
+  /// @return true if a non-expired entry was found, either with
+  ///         endpoints or with the error of the failed lookup
+  bool lookup(std::string const& host, std::string const& port,
+              std::chrono::milliseconds ttl,
+              std::chrono::milliseconds negativeTtl, Endpoints& endpoints,
+              asio_ns::error_code& ec);
+
+  /// @brief store a resolve result, thread-safe
+  void store(std::string const& host, std::string const& port,
+             Endpoints endpoints, asio_ns::error_code const& ec);
+
+  /// @brief forget the entry, thread-safe. Called once none of its
+  /// endpoints accepted a connection, the next connect resolves again.
+  void invalidate(std::string const& host, std::string const& port);
+
+ private:
+  struct Entry {
+    Endpoints endpoints;
+    asio_ns::error_code ec;
+    std::chrono::steady_clock::time_point resolved;
+  };
+
+  std::mutex _mutex;
+  std::unordered_map<std::string, Entry> _entries;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "TlsSessionCache.h"
+
+#include <fuerte/FuerteLogger.h>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+namespace {
+// asio keeps its verify callbacks in the app data slots, so we need
+// private ex_data indices
+int contextIndex() {
+  static int const index =
+      SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+  return index;
+}
+
+int sslIndex() {
+  static int const index =
+      SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+  return index;
+}
+}  // namespace
+
+TlsSessionCache::~TlsSessionCache() {
+  for (auto& pair : _sessions) {
+    SSL_SESSION_free(pair.second);
+  }
+}
+
+void TlsSessionCache::attach(asio_ns::ssl::context& ctx) {
+  SSL_CTX* native = ctx.native_handle();
+  SSL_CTX_set_ex_data(native, contextIndex(), this);
+  // we manage sessions ourselves, keyed by endpoint
+  SSL_CTX_set_session_cache_mode(
+      native, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb(native, &TlsSessionCache::onNewSession);
+}
+
+void TlsSessionCache::prepare(SSL* ssl, std::string const& key) {
+  SSL_set_ex_data(ssl, sslIndex(), const_cast<std::string*>(&key));
+
+  std::lock_guard<std::mutex> guard(_mutex);
+  auto it = _sessions.find(key);
+  if (it == _sessions.end()) {
+    return;
+  }
+#if (OPENSSL_VERSION_NUMBER >= 0x10101000L)
+  if (!SSL_SESSION_is_resumable(it->second)) {
+    SSL_SESSION_free(it->second);
+    _sessions.erase(it);
+    return;
+  }
+#endif
+  // takes its own reference, a failed resumption falls back to a full
+  // handshake
+  if (SSL_set_session(ssl, it->second) != 1) {
+    FUERTE_LOG_DEBUG << "unable to resume TLS session\n";
+  }
+}
+
+void TlsSessionCache::remove(std::string const& key) {
+  std::lock_guard<std::mutex> guard(_mutex);
+  auto it = _sessions.find(key);
+  if (it != _sessions.end()) {
+    SSL_SESSION_free(it->second);
+    _sessions.erase(it);
+  }
+}
+
+void TlsSessionCache::store(std::string const& key, SSL_SESSION* session) {
+  std::lock_guard<std::mutex> guard(_mutex);
+  auto& entry = _sessions[key];
+  if (entry != nullptr) {
+    SSL_SESSION_free(entry);
+  }
+  entry = session;
+}
+
+// called by OpenSSL on the IO-Thread of the connection
+int TlsSessionCache::onNewSession(SSL* ssl, SSL_SESSION* session) {
+  auto* cache = static_cast<TlsSessionCache*>(
+      SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), contextIndex()));
+  auto const* key =
+      static_cast<std::string const*>(SSL_get_ex_data(ssl, sslIndex()));
+  if (cache == nullptr || key == nullptr) {
+    return 0;  // not ours, OpenSSL frees the session
+  }
+  cache->store(*key, session);
+  return 1;  // we took ownership of the reference
+}
+
+}}}  // namespace arangodb::fuerte::v1
@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef ARANGO_CXX_DRIVER_TLS_SESSION_CACHE_H
+#define ARANGO_CXX_DRIVER_TLS_SESSION_CACHE_H 1
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <fuerte/asio_ns.h>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+/// @brief TlsSessionCache keeps the last TLS session (ticket or session ID)
+/// per endpoint, so reconnects can resume the session instead of doing a
+/// full handshake. Sessions are recorded via the new-session callback of
+/// the shared client SSL context, which also covers TLS 1.3 tickets that
+/// only arrive after the handshake.
+class TlsSessionCache {
+ public:
+  TlsSessionCache() = default;
+  ~TlsSessionCache();
+
+  TlsSessionCache(TlsSessionCache const&) = delete;
+  TlsSessionCache& operator=(TlsSessionCache const&) = delete;
+
+  /// @brief enable client side session caching on the context
+  void attach(asio_ns::ssl::context&);
+
+  /// @brief set a cached session (if any) on a new connection and record
+  /// further sessions under `key`. The key must outlive the SSL object.
+  void prepare(SSL* ssl, std::string const& key);
+
+  /// @brief forget the session of an endpoint, i.e. after a failed handshake
+  void remove(std::string const& key);
+
+ private:
+  static int onNewSession(SSL*, SSL_SESSION*);
+  void store(std::string const& key, SSL_SESSION*);
+
+ private:
+  std::mutex _mutex;
+  std::unordered_map<std::string, SSL_SESSION*> _sessions;
+};
+
+}}}  // namespace arangodb::fuerte::v1
+#endif
@@ -24,6 +24,7 @@
 
 #include "VstConnection.h"
 
+#include "AllocatedPayload.h"
 #include "Basics/cpu-relax.h"
 
 #include <fuerte/FuerteLogger.h>
@@ -41,7 +42,7 @@ template <SocketType ST>
 VstConnection<ST>::VstConnection(
     EventLoopService& loop, fu::detail::ConnectionConfiguration const& config)
     : fuerte::GeneralConnection<ST>(loop, config),
-      _writeQueue(),
+      _writeQueue(config._priorityWeights),
       _vstVersion(config._vstVersion),
       _reading(false),
       _writing(false) {}
@@ -56,25 +57,39 @@ static std::atomic<MessageID> vstMessageId(1);
 // sendRequest prepares a RequestItem for the given parameters
 // and adds it to the send queue.
 template <SocketType ST>
-MessageID VstConnection<ST>::sendRequest(std::unique_ptr<Request> req,
-                                         RequestCallback cb) {
+MessageID VstConnection<ST>::trySendRequest(std::unique_ptr<Request>& req,
+                                            RequestHandler& cb) {
+  // fail fast while the endpoint is known to be down
+  bool probe;
+  if (!this->allowRequest(probe)) {
+    uint64_t mid = vstMessageId.fetch_add(1, std::memory_order_relaxed);
+    this->failRequest(Error::CircuitOpen, std::move(req), std::move(cb));
+    return mid;
+  }
+
+  if (!this->acquireQueueSlot()) {
+    this->releaseProbe(probe);  // let the next request probe instead
+    return 0;  // caller keeps the request
+  }
+
   // it does not matter if IDs are reused on different connections
   uint64_t mid = vstMessageId.fetch_add(1, std::memory_order_relaxed);
+
   // Create RequestItem from parameters
-  auto item = std::make_unique<RequestItem>();
+  auto item = this->_pools.vstItems.acquirePtr();
   item->_messageID = mid;
+  item->_probe = probe;
   item->_request = std::move(req);
-  item->_callback = cb;
-  item->_expires = std::chrono::steady_clock::time_point::max();
+  this->bindExecutor(cb);
+  item->_callback = std::move(cb);
+  item->_expires = this->requestDeadline(*item->_request);
+  auto const deadline = item->_expires;
+
+  // Add item to send queue, the bound is enforced by acquireQueueSlot
+  RequestPriority priority = item->_request->priority();
+  _writeQueue.push(item.release(), priority);  // queue owns this now
+  this->watchDeadline(deadline);  // fails even if it is never dequeued
 
-  // Add item to send queue
-  if (!_writeQueue.push(item.get())) {
-    FUERTE_LOG_ERROR << "connection queue capacity exceeded\n";
-    throw std::length_error("connection queue capacity exceeded");
-  }
-  item.release();  // queue owns this now
-  
-  this->_numQueued.fetch_add(1, std::memory_order_relaxed);
   FUERTE_LOG_VSTTRACE << "queued item: this=" << this << "\n";
   
   // _state.load() after queuing request, to prevent race with connect
@@ -132,6 +147,7 @@ void VstConnection<ST>::finishConnect() {
           FUERTE_LOG_ERROR << ec.message() << "\n";
           thisPtr->shutdownConnection(Error::CouldNotConnect,
                                       "unable to connect: " + ec.message());
+          thisPtr->onConnect(Error::CouldNotConnect);
           thisPtr->drainQueue(Error::CouldNotConnect);
           return;
         }
@@ -142,6 +158,7 @@ void VstConnection<ST>::finishConnect() {
         } else {
           thisPtr->_state.store(Connection::State::Connected,
                                 std::memory_order_release);
+          thisPtr->onConnect(Error::NoError);
           thisPtr->startWriting();  // start writing if something is queued
         }
       });
@@ -165,9 +182,11 @@ void VstConnection<ST>::sendAuthenticationRequest() {
                             std::memory_order_release);
       thisPtr->shutdownConnection(Error::VstUnauthorized,
                                   "could not authenticate");
+      thisPtr->onConnect(Error::VstUnauthorized);
       thisPtr->drainQueue(Error::VstUnauthorized);
     } else {
       thisPtr->_state.store(Connection::State::Connected);
+      thisPtr->onConnect(Error::NoError);
       thisPtr->startWriting();
     }
   };
@@ -244,43 +263,61 @@ void VstConnection<ST>::asyncWriteNextRequest() {
   
    while(true) { // loop instead of recursion
     
-      RequestItem* ptr = nullptr;
-      if (!_writeQueue.pop(ptr)) {
+      std::shared_ptr<RequestItem> item;
+      if (_partialItem && _partialItem->_pendingError != Error::NoError) {
+        // timed out or canceled while being written, the server has seen
+        // part of the message: finish it before anything else goes out
+        item = _partialItem;
+      } else if (_partialItem) {
+        // more urgent requests may overtake a partially written message
+        RequestItem* ptr = popQueue(_partialItem.get());
+        item = ptr != nullptr ? startRequest(ptr) : _partialItem;
+        
+      } else {
+        RequestItem* ptr = popQueue(nullptr);
+        if (ptr == nullptr) {
         
-        FUERTE_LOG_VSTTRACE
-            << "asyncWriteNextRequest (vst): write queue empty\n";
-              
-        // careful now, we need to consider that someone queues
-        // a new request item
-        _writing.store(false);
-        if (_writeQueue.empty()) {
           FUERTE_LOG_VSTTRACE
-              << "asyncWriteNextRequest (vst): write stopped\n";
-          break; // done, someone else may restart
+              << "asyncWriteNextRequest (vst): write queue empty\n";
+              
+          // careful now, we need to consider that someone queues
+          // a new request item
+          _writing.store(false);
+          bool empty;
+          {
+            std::lock_guard<std::mutex> guard(_writeQueueMutex);
+            empty = _writeQueue.empty();
+          }
+          if (empty) {
+            FUERTE_LOG_VSTTRACE
+                << "asyncWriteNextRequest (vst): write stopped\n";
+            break; // done, someone else may restart
+          }
+
+          bool expected = false; // may fail in a race
+          if (_writing.compare_exchange_strong(expected, true)) {
+            continue; // we re-start writing
+          }
+          assert(expected == true);
+          break; // someone else restarted writing
         }
-
-        bool expected = false; // may fail in a race
-        if (_writing.compare_exchange_strong(expected, true)) {
-          continue; // we re-start writing
+        
+        item = startRequest(ptr);
+        // large messages below the highest priority are written a few
+        // chunks at a time, so more urgent messages can be interleaved
+        if (item->numChunks() > chunksPerWrite &&
+            item->_request->priority() != RequestPriority::High) {
+          _partialItem = item;
         }
-        assert(expected == true);
-        break; // someone else restarted writing
       }
-     
-     this->_numQueued.fetch_sub(1, std::memory_order_relaxed);
-    
-    std::shared_ptr<RequestItem> item(ptr);
-
-    // set the point-in-time when this request expires
-    if (item->_request && item->_request->timeout().count() > 0) {
-      item->_expires =
-          std::chrono::steady_clock::now() + item->_request->timeout();
-    }
-     
-    _messageStore.add(item);  // Add item to message store
-    setTimeout();             // prepare request / connection timeouts
 
-    asio_ns::async_write(this->_proto->socket, item->prepareForNetwork(_vstVersion),
+    std::size_t maxChunks = item == _partialItem &&
+                                    item->_pendingError == Error::NoError
+                                ? chunksPerWrite
+                                : item->numChunks();
+    auto buffers = item->nextChunks(maxChunks);
+    item->_sending = true;
+    asio_ns::async_write(this->_proto->socket, std::move(buffers),
                         [self = Connection::shared_from_this(), req(std::move(item))]
                         (asio_ns::error_code const& ec, std::size_t nwrite) mutable {
      auto& thisPtr = static_cast<VstConnection<ST>&>(*self);
@@ -293,23 +330,86 @@ void VstConnection<ST>::asyncWriteNextRequest() {
   FUERTE_LOG_VSTTRACE << "asyncWrite: done\n";
 }
 
+template <SocketType ST>
+RequestItem* VstConnection<ST>::popQueue(RequestItem const* partial) {
+  while (true) {
+    RequestItem* ptr = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(_writeQueueMutex);
+      ptr = partial ? _writeQueue.popAbove(partial->_request->priority())
+                    : _writeQueue.pop();
+    }
+    if (ptr == nullptr) {
+      return nullptr;
+    }
+    if (!ptr->_request) {  // failed by expireQueued() already
+      ObjectPool<RequestItem>::Ptr guard(ptr, {&this->_pools.vstItems});
+      this->releaseQueueSlot();
+      continue;
+    }
+    Error err = Error::NoError;
+    if (ptr->_pendingError != Error::NoError) {
+      err = ptr->_pendingError;  // canceled before it was written
+    } else if (ptr->_expires <= std::chrono::steady_clock::now()) {
+      FUERTE_LOG_DEBUG << "VST-Request expired in queue\n";
+      if (ptr->_probe) {
+        this->reportFailure(true);  // the probe got no answer in time
+      }
+      err = Error::Timeout;  // don't bother the server
+    } else {
+      return ptr;
+    }
+    ObjectPool<RequestItem>::Ptr guard(ptr, {&this->_pools.vstItems});
+    this->releaseQueueSlot();
+    guard->invokeOnError(err);
+  }
+}
+
+// move a dequeued request into the message store, ready for writing
+template <SocketType ST>
+std::shared_ptr<RequestItem> VstConnection<ST>::startRequest(
+    RequestItem* ptr) {
+  this->releaseQueueSlot();
+
+  // the control block is allocated here, the item itself is pooled
+  std::shared_ptr<RequestItem> item(
+      ptr, ObjectPool<RequestItem>::Recycler{&this->_pools.vstItems});
+
+  _messageStore.add(item);  // Add item to message store
+  setTimeout();             // prepare request / connection timeouts
+
+  if (!this->_config._deadlineHeader.empty() &&
+      item->_expires != std::chrono::steady_clock::time_point::max()) {
+    StringMap meta{{this->_config._deadlineHeader,
+                    this->deadlineHeaderValue(item->_expires)}};
+    item->prepareForNetwork(_vstVersion, &meta);
+  } else {
+    item->prepareForNetwork(_vstVersion);
+  }
+  return item;
+}
+
 // callback of async_write function that is called in sendNextRequest.
 template <SocketType ST>
 void VstConnection<ST>::asyncWriteCallback(asio_ns::error_code const& ec,
                                            std::shared_ptr<RequestItem> item,
                                            std::size_t nwrite) {
   // auto pendingAsyncCalls = --_connection->_async_calls;
+  item->_sending = false;
   if (ec) {
     // Send failed
     FUERTE_LOG_VSTTRACE << "asyncWriteCallback: error " << ec.message() << "\n";
 
     // Item has failed, remove from message store
     _messageStore.removeByID(item->_messageID);
+    this->reportFailure(item->_probe);
     
     auto err = translateError(ec, Error::WriteError);
     try {
       // let user know that this request caused the error
-      item->_callback(err, std::move(item->_request), nullptr);
+      Error reported =
+          item->_pendingError != Error::NoError ? item->_pendingError : err;
+      item->_callback(reported, std::move(item->_request), nullptr);
     } catch(...) {}
     // Stop current connection and try to restart a new one.
     this->restartConnection(err);
@@ -319,8 +419,19 @@ void VstConnection<ST>::asyncWriteCallback(asio_ns::error_code const& ec,
   FUERTE_LOG_VSTTRACE << "asyncWriteCallback: send succeeded, "
                        << nwrite << " bytes send\n";
 
-  // request is written we no longer need data for that
-  item->resetSendData();
+  if (item->_pendingError != Error::NoError && item->sendComplete()) {
+    // failed while being written, the whole message is out now
+    Error err = item->_pendingError;
+    item->_pendingError = Error::NoError;
+    item->invokeOnError(err);
+  }
+  if (item->sendComplete() || !item->_request) {
+    if (item == _partialItem) {
+      _partialItem.reset();
+    }
+    // request is written we no longer need data for that
+    item->resetSendData();
+  }
 
   startReading();  // Make sure we're listening for a response
 
@@ -352,17 +463,31 @@ void VstConnection<ST>::asyncReadCallback(asio_ns::error_code const& ec) {
     FUERTE_LOG_VSTTRACE
         << "asyncReadCallback: Error while reading form socket: "
         << ec.message();
+    if (!_messageStore.empty()) {
+      bool probe = false;
+      _messageStore.invokeOnAll([&](RequestItem* item) {
+        probe = probe || item->_probe;
+        return true;
+      });
+      this->reportFailure(probe);
+    }
     this->restartConnection(translateError(ec, Error::ReadError));
     return;
   }
 
   // Inspect the data we've received so far.
-  auto recvBuffs = this->_receiveBuffer.data();  // no copy
-  auto cursor = asio_ns::buffer_cast<const uint8_t*>(recvBuffs);
-  auto available = asio_ns::buffer_size(recvBuffs);
-  // TODO technically buffer_cast is deprecated
+  auto recvBuff = this->_receiveBuffer.data();  // no copy, contiguous
+  auto cursor = static_cast<const uint8_t*>(recvBuff.data());
+  auto available = recvBuff.size();
 
   size_t parsedBytes = 0;
+  if (_skipRemaining > 0) {  // rest of a dropped chunk
+    size_t n = std::min(_skipRemaining, available);
+    _skipRemaining -= n;
+    cursor += n;
+    available -= n;
+    parsedBytes += n;
+  }
   while (true) {
     Chunk chunk;
     parser::ChunkState state = parser::ChunkState::Invalid;
@@ -372,14 +497,32 @@ void VstConnection<ST>::asyncReadCallback(asio_ns::error_code const& ec) {
       state = vst::parser::readChunkVST1_0(chunk, cursor, available);
     }
 
-    if (parser::ChunkState::Incomplete == state) {
-      break;
-    } else if (parser::ChunkState::Invalid == state) {
+    if (parser::ChunkState::Invalid == state) {
       this->shutdownConnection(Error::ProtocolError,
                                "Invalid VST chunk");
       return;
     }
 
+    // limits apply as soon as a chunk header is known, VST 1.0 headers
+    // vary in length so only complete chunks are checked there
+    bool complete = parser::ChunkState::Complete == state;
+    bool haveHeader =
+        complete || (_vstVersion == VST1_1 && available >= maxChunkHeaderSize);
+    if (haveHeader) {
+      checkLimits(chunk.header,
+                  complete ? chunk.body.size()
+                           : chunk.header.chunkLength() - maxChunkHeaderSize);
+    }
+
+    if (!complete) {
+      if (haveHeader && skipChunk(chunk.header, available)) {
+        parsedBytes += available;  // the rest is dropped as it arrives
+      } else if (startReadInto(chunk, cursor, available)) {
+        parsedBytes += available;  // the partial chunk is in its item now
+      }
+      break;
+    }
+
     // move cursors
     cursor += chunk.header.chunkLength();
     available -= chunk.header.chunkLength();
@@ -391,11 +534,69 @@ void VstConnection<ST>::asyncReadCallback(asio_ns::error_code const& ec) {
 
   // Remove consumed data from receive buffer.
   this->_receiveBuffer.consume(parsedBytes);
+  continueReading();
+}
+
+// called by the handler of asyncReadInto (called from IO thread)
+template <SocketType ST>
+void VstConnection<ST>::asyncReadIntoCallback(asio_ns::error_code const& ec,
+                                              std::size_t nread) {
+  // keeps the target buffer alive up to here
+  std::shared_ptr<RequestItem> item = std::move(_readIntoItem);
+  if (ec) {
+    asyncReadCallback(ec);
+    return;
+  }
+
+  assert(item && nread <= _readIntoRemaining);
+  item->_buffer.advance(nread);  // the bytes are in place already
+  _readIntoRemaining -= nread;
+  if (_readIntoRemaining > 0) {
+    _readIntoItem = std::move(item);
+  } else if (_messageStore.findByID(item->_messageID) == item) {
+    assembleResponse(*item);
+  }  // otherwise canceled or timed out meanwhile, drop the chunk
+  continueReading();
+}
+
+template <SocketType ST>
+bool VstConnection<ST>::startReadInto(Chunk& chunk, uint8_t const* cursor,
+                                      std::size_t available) {
+  // VST 1.0 chunk headers vary in length, they take the usual way
+  if (_vstVersion != VST1_1 || available < maxChunkHeaderSize ||
+      chunk.header.chunkLength() < available + this->directReadMinSize) {
+    return false;
+  }
+  auto item = _messageStore.findByID(chunk.header.messageID());
+  if (!item) {
+    return false;
+  }
+
+  // the received part of the body goes to the item right away
+  chunk.body = asio_ns::const_buffer(cursor + maxChunkHeaderSize,
+                                     available - maxChunkHeaderSize);
+  item->addPartialChunk(chunk,
+                        chunk.header.chunkLength() - maxChunkHeaderSize);
+  _readIntoRemaining = chunk.header.chunkLength() - available;
+  _readIntoItem = std::move(item);
+  return true;
+}
+
+template <SocketType ST>
+void VstConnection<ST>::continueReading() {
+  if (_readIntoItem) {  // rest of a large chunk, read it in place
+    auto& buffer = _readIntoItem->_buffer;
+    this->asyncReadInto(
+        asio_ns::mutable_buffer(buffer.data() + buffer.size(),
+                                _readIntoRemaining));
+    return;
+  }
 
   // check for more messages that could arrive
   if (_messageStore.empty()/* && !_writing.load()*/) {
     FUERTE_LOG_VSTTRACE << "shouldStopReading: no more pending "
                            "messages/requests, stopping read";
+    this->_receiveBuffer.release();  // idle, no need to hold on to memory
     _reading.store(false);
     return;  // write-loop restarts read-loop if necessary
   }
@@ -413,28 +614,87 @@ void VstConnection<ST>::processChunk(Chunk const& chunk) {
   // Find requestItem for this chunk.
   auto item = _messageStore.findByID(chunk.header.messageID());
   if (!item) {
-    FUERTE_LOG_ERROR << "got chunk with unknown message ID: " << msgID << "\n";
+    if (!dropChunk(chunk.header)) {
+      FUERTE_LOG_ERROR << "got chunk with unknown message ID: " << msgID << "\n";
+    }
     return;
   }
 
   // We've found the matching RequestItem.
   item->addChunk(chunk);
+  assembleResponse(*item);
+}
+
+// Count a chunk of a canceled request, false if the message is unknown
+template <SocketType ST>
+bool VstConnection<ST>::dropChunk(ChunkHeader const& header) {
+  auto it = _canceledResponses.find(header.messageID());
+  if (it == _canceledResponses.end()) {
+    return false;
+  }
+  // late response to a canceled request, drop it
+  if (header.isFirst()) {
+    it->second.chunks = header.numberOfChunks();
+  }
+  if (it->second.chunks <= 1) {
+    _canceledResponses.erase(it);
+  } else {
+    it->second.chunks--;
+  }
+  return true;
+}
+
+// Skip the rest of an incomplete chunk of a canceled request
+template <SocketType ST>
+bool VstConnection<ST>::skipChunk(ChunkHeader const& header,
+                                  std::size_t available) {
+  assert(header.chunkLength() > available);
+  if (!dropChunk(header)) {
+    return false;
+  }
+  _skipRemaining = header.chunkLength() - available;
+  return true;
+}
 
+// Fail the response if the chunk takes it over a limit
+template <SocketType ST>
+void VstConnection<ST>::checkLimits(ChunkHeader const& header,
+                                    std::size_t bodyLength) {
+  auto item = _messageStore.findByID(header.messageID());
+  if (!item) {
+    return;  // canceled or unknown, dropped anyway
+  }
+  // messageLength is 0 if not known from this chunk (VST 1.0)
+  uint64_t size = std::max<uint64_t>(header.messageLength(),
+                                     item->_buffer.size() + bodyLength);
+  Error err = this->reserveResponse(item->_chargedBytes, size);
+  if (err != Error::NoError) {
+    FUERTE_LOG_DEBUG << "response rejected: " << to_string(err)
+                     << ", messageID=" << header.messageID() << "\n";
+    failResponse(header.messageID(), err);  // drops its chunks from now on
+  }
+}
+
+// Hand out the response of the item if all its chunks are there.
+template <SocketType ST>
+void VstConnection<ST>::assembleResponse(RequestItem& item) {
   // Try to assembly chunks in RequestItem to complete response.
-  auto completeBuffer = item->assemble();
+  auto completeBuffer = item.assemble();
   if (completeBuffer) {
     FUERTE_LOG_VSTTRACE << "processChunk: complete response received\n";
     this->_timeout.cancel();
+    this->releaseResponse(item._chargedBytes);  // handed out now
 
     // Message is complete
     // Remove message from store
-    _messageStore.removeByID(item->_messageID);
+    _messageStore.removeByID(item._messageID);
+    this->reportSuccess(item._probe);
 
     try {
       // Create response
-      auto resp = createResponse(*item, completeBuffer);
+      auto resp = createResponse(item, completeBuffer);
       auto err = resp != nullptr ? Error::NoError : Error::ProtocolError;
-      item->_callback(err, std::move(item->_request), std::move(resp));
+      item._callback(err, std::move(item._request), std::move(resp));
     } catch(...) {
       FUERTE_LOG_ERROR << "unhandled exception in fuerte callback\n";
     }
@@ -463,8 +723,22 @@ std::unique_ptr<fu::Response> VstConnection<ST>::createResponse(
 
   ResponseHeader header =
       parser::responseHeaderFromSlice(VPackSlice(itemCursor));
-  auto response = std::make_unique<Response>(std::move(header));
-  response->setPayload(std::move(*responseBuffer), /*offset*/ headerLength);
+  std::unique_ptr<Response> response(this->_pools.responses.acquire());
+  response->header = std::move(header);
+  // the body goes to the storage of the allocator if the request has one,
+  // chunks may arrive in any order so it is copied once complete
+  PayloadSlice allocated;
+  if (auto const& allocator = item._request->responseAllocator()) {
+    allocated = AllocatedPayload::copy(allocator, itemCursor + headerLength,
+                                       itemLength - headerLength);
+  }
+  if (allocated.empty()) {
+    response->swapPayload(*responseBuffer, /*offset*/ headerLength);
+    // the buffer of a recycled response is kept by the pooled item
+    item._buffer = std::move(*responseBuffer);
+  } else {
+    response->setPayload(std::move(allocated));
+  }
 
   return response;
 }
@@ -499,11 +773,26 @@ void VstConnection<ST>::setTimeout() {
     size_t waiting = thisPtr->_messageStore.invokeOnAll([&](RequestItem* item) {
       if (item->_expires < now) {
         FUERTE_LOG_DEBUG << "VST-Request timeout\n";
-        item->invokeOnError(Error::Timeout);
+        thisPtr->releaseResponse(item->_chargedBytes);
+        thisPtr->reportFailure(item->_probe);
+        if (item->writeStarted()) {
+          item->_pendingError = Error::Timeout;  // must outlive the write
+        } else {
+          item->invokeOnError(Error::Timeout);
+        }
         return false;  // remove
       }
       return true;
     });
+    // responses of canceled requests that did not arrive in time never will
+    auto& canceled = thisPtr->_canceledResponses;
+    for (auto it = canceled.begin(); it != canceled.end();) {
+      if (it->second.expires < now) {
+        it = canceled.erase(it);
+      } else {
+        ++it;
+      }
+    }
     if (waiting == 0) {  // no more messages to wait on
       FUERTE_LOG_DEBUG << "VST-Connection timeout\n";
       thisPtr->shutdownConnection(Error::Timeout);
@@ -520,21 +809,116 @@ void VstConnection<ST>::abortOngoingRequests(const fuerte::Error err) {
   // Reset the read & write loop
   // Cancel all items and remove them from the message store.
   if (err != Error::VstUnauthorized) { // prevents stack overflow
+    _messageStore.invokeOnAll([&](RequestItem* item) {
+      this->releaseResponse(item->_chargedBytes);
+      return true;
+    });
     _messageStore.cancelAll(err);
   }
+  _partialItem.reset();
+  _canceledResponses.clear();
+  _skipRemaining = 0;
   _reading.store(false);
   _writing.store(false);
 }
 
+/// skip a queued request, forget an in-flight one
+template <SocketType ST>
+bool VstConnection<ST>::abortRequest(MessageID mid) {
+  if (failResponse(mid, Error::Canceled)) {
+    return true;
+  }
+  std::lock_guard<std::mutex> guard(_writeQueueMutex);
+  RequestItem* item = _writeQueue.find(
+      [mid](RequestItem const* i) { return i->_messageID == mid; });
+  if (item == nullptr) {
+    return false;  // done already
+  }
+  item->_pendingError = Error::Canceled;  // skipped by popQueue()
+  return true;
+}
+
+/// fail an in-flight request with `err`, its response is discarded
+template <SocketType ST>
+bool VstConnection<ST>::failResponse(MessageID mid, Error err) {
+  auto item = _messageStore.findByID(mid);
+  if (!item) {
+    return false;  // queued or done
+  }
+  _messageStore.removeByID(mid);
+  this->releaseResponse(item->_chargedBytes);
+
+  // count the response chunks that may still arrive
+  std::size_t expected = 0;
+  if (item->_responseNumberOfChunks > 0) {
+    expected = item->_responseNumberOfChunks - item->_responseChunks.size();
+  }
+  _canceledResponses.emplace(mid, CanceledResponse{expected, item->_expires});
+
+  if (item->writeStarted()) {
+    item->_pendingError = err;  // the request must outlive the write
+  } else {
+    item->invokeOnError(err);
+  }
+  setTimeout();  // readjust timeout
+  return true;
+}
+
+template <SocketType ST>
+bool VstConnection<ST>::probeQueued() {
+  std::lock_guard<std::mutex> guard(_writeQueueMutex);
+  return _writeQueue.find([](RequestItem const* i) {
+           return i->_probe && i->_request;
+         }) != nullptr;
+}
+
 /// abort all requests lingering in the queue
 template <SocketType ST>
 void VstConnection<ST>::drainQueue(const fuerte::Error ec) {
-  RequestItem* item = nullptr;
-  while (_writeQueue.pop(item)) {
-    std::unique_ptr<RequestItem> guard(item);
-    this->_numQueued.fetch_sub(1, std::memory_order_relaxed);
-    guard->invokeOnError(ec);
+  std::vector<ObjectPool<RequestItem>::Ptr> items;
+  {  // take everything at once, callbacks may queue new requests
+    std::lock_guard<std::mutex> guard(_writeQueueMutex);
+    _writeQueue.drain([&](RequestItem* item) {
+      items.emplace_back(item, ObjectPool<RequestItem>::Recycler{
+                                   &this->_pools.vstItems});
+    });
+  }
+  for (auto& item : items) {
+    this->releaseQueueSlot();
+    if (item->_request) {  // not failed by expireQueued() already
+      item->invokeOnError(ec);
+    }
+  }
+}
+
+template <SocketType ST>
+std::chrono::steady_clock::time_point VstConnection<ST>::expireQueued(
+    std::chrono::steady_clock::time_point now) {
+  std::vector<std::pair<RequestHandler, std::unique_ptr<Request>>> expired;
+  auto next = std::chrono::steady_clock::time_point::max();
+  {
+    std::lock_guard<std::mutex> guard(_writeQueueMutex);
+    _writeQueue.find([&](RequestItem* item) {
+      if (!item->_request || item->_pendingError != Error::NoError) {
+        return false;  // failed already or fails once dequeued
+      }
+      if (item->_expires <= now) {  // the husk is skipped by popQueue()
+        if (item->_probe) {
+          this->reportFailure(true);  // the probe got no answer in time
+        }
+        expired.emplace_back(std::move(item->_callback),
+                             std::move(item->_request));
+      } else {
+        next = std::min(next, item->_expires);
+      }
+      return false;  // visit every item
+    });
+  }
+  for (auto& pair : expired) {  // callbacks may queue new requests
+    FUERTE_LOG_DEBUG << "VST-Request expired in queue\n";
+    pair.first(Error::Timeout, std::move(pair.second), nullptr);
   }
+  return next;
 }
 
 template class arangodb::fuerte::v1::vst::VstConnection<SocketType::Tcp>;
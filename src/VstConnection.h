@@ -25,11 +25,13 @@
 #ifndef ARANGO_CXX_DRIVER_VST_CONNECTION_H
 #define ARANGO_CXX_DRIVER_VST_CONNECTION_H 1
 
+#include <unordered_map>
+
 #include "GeneralConnection.h"
 #include "MessageStore.h"
+#include "PriorityQueue.h"
 #include "vst.h"
 
-#include <boost/lockfree/queue.hpp>
 
 // naming in this file will be closer to asio for internal functions and types
 // functions that are exposed to other classes follow ArangoDB conding
@@ -55,7 +57,8 @@ class VstConnection final : public fuerte::GeneralConnection<ST> {
   // this item is then moved to the request queue
   // and a write action is triggerd when there is
   // no other write in progress
-  MessageID sendRequest(std::unique_ptr<Request>, RequestCallback) override;
+  MessageID trySendRequest(std::unique_ptr<Request>&,
+                           RequestHandler&) override;
 
   // Return the number of unfinished requests.
   std::size_t requestsLeft() const override;
@@ -69,16 +72,37 @@ class VstConnection final : public fuerte::GeneralConnection<ST> {
   // called by the async_read handler (called from IO thread)
   void asyncReadCallback(asio_ns::error_code const&) override;
 
+  // called by the handler of asyncReadInto (called from IO thread)
+  void asyncReadIntoCallback(asio_ns::error_code const&,
+                             std::size_t nread) override;
+
   /// abort ongoing / unfinished requests
   void abortOngoingRequests(const fuerte::Error) override;
 
   /// abort all requests lingering in the queue
   void drainQueue(const fuerte::Error) override;
 
+  /// is the circuit breaker probe among the queued requests
+  bool probeQueued() override;
+
+  /// skip a queued request, forget an in-flight one
+  bool abortRequest(MessageID) override;
+
+  /// fail queued requests past their deadline
+  std::chrono::steady_clock::time_point expireQueued(
+      std::chrono::steady_clock::time_point now) override;
+
  private:
   ///  Call on IO-Thread: writes out one queued request
   void asyncWriteNextRequest();
 
+  /// Call on IO-Thread: register a dequeued request as in-flight
+  std::shared_ptr<RequestItem> startRequest(RequestItem*);
+
+  /// Call on IO-Thread: take the next queued request, of a priority
+  /// above `partial` if set. Skips canceled requests.
+  RequestItem* popQueue(RequestItem const* partial);
+
   // called by the async_write handler (called from IO thread)
   void asyncWriteCallback(asio_ns::error_code const& ec,
                           std::shared_ptr<RequestItem>,
@@ -93,6 +117,22 @@ class VstConnection final : public fuerte::GeneralConnection<ST> {
 
   // Process the given incoming chunk.
   void processChunk(Chunk const& chunk);
+  // Hand out the response of the item if all its chunks are there.
+  void assembleResponse(RequestItem& item);
+  // Count a chunk of a canceled request, false if the message is unknown
+  bool dropChunk(ChunkHeader const& header);
+  // Skip the rest of an incomplete chunk of a canceled request
+  bool skipChunk(ChunkHeader const& header, std::size_t available);
+  // Fail the response if the chunk takes it over a limit
+  void checkLimits(ChunkHeader const& header, std::size_t bodyLength);
+  // Fail an in-flight request, its response chunks are dropped
+  bool failResponse(MessageID mid, Error err);
+  // Read the rest of a large incomplete chunk straight into its item,
+  // false if it is read the usual way
+  bool startReadInto(Chunk& chunk, uint8_t const* cursor,
+                     std::size_t available);
+  // Continue the read loop, stops it when no responses are pending
+  void continueReading();
   // Create a response object for given RequestItem & received response buffer.
   std::unique_ptr<Response> createResponse(
       RequestItem& item, std::unique_ptr<velocypack::Buffer<uint8_t>>&);
@@ -101,13 +141,36 @@ class VstConnection final : public fuerte::GeneralConnection<ST> {
   void setTimeout();
 
  private:
-  /// elements to send out
-  boost::lockfree::queue<vst::RequestItem*, boost::lockfree::capacity<1024>>
-      _writeQueue;
+  /// elements to send out, by priority
+  PriorityQueue<vst::RequestItem> _writeQueue;
+  /// serializes consumers of _writeQueue, producers never take it
+  std::mutex _writeQueueMutex;
 
   /// stores in-flight messages
   MessageStore<vst::RequestItem> _messageStore;
 
+  /// large message that is written a few chunks at a time (IO-Thread only)
+  std::shared_ptr<RequestItem> _partialItem;
+  /// chunks per write of a partially written message
+  static constexpr std::size_t chunksPerWrite = 4;
+
+  /// a canceled request whose response may still arrive
+  struct CanceledResponse {
+    /// response chunks still expected, 0 if unknown
+    std::size_t chunks;
+    /// forgotten after the deadline of the request, see setTimeout()
+    std::chrono::steady_clock::time_point expires;
+  };
+  /// late chunks of these are dropped silently (IO-Thread only)
+  std::unordered_map<MessageID, CanceledResponse> _canceledResponses;
+
+  /// item receiving the rest of a large chunk in place (IO-Thread only)
+  std::shared_ptr<RequestItem> _readIntoItem;
+  /// bytes of that chunk still to come
+  std::size_t _readIntoRemaining = 0;
+  /// bytes of a dropped chunk still to come (IO-Thread only)
+  std::size_t _skipRemaining = 0;
+
   const VSTVersion _vstVersion;
 
   /// highest two bits mean read or write loops are active
@@ -23,7 +23,8 @@
 
 #include <fuerte/FuerteLogger.h>
 #include <fuerte/connection.h>
-#include <fuerte/waitgroup.h>
+
+#include "OneShotEvent.h"
 
 namespace arangodb { namespace fuerte { inline namespace v1 {
 // Deconstructor
@@ -34,37 +35,49 @@ Connection::~Connection() {
 // sendRequest and wait for it to finished.
 std::unique_ptr<Response> Connection::sendRequest(
     std::unique_ptr<Request> request) {
-  FUERTE_LOG_TRACE << "sendRequest (sync): before send" << std::endl;
-
-  WaitGroup wg;
-  auto rv = std::unique_ptr<Response>(nullptr);
-  ::arangodb::fuerte::v1::Error error = Error::NoError;
+  RequestResult result = sendRequest(std::move(request), std::nothrow);
+  if (result.error != Error::NoError) {
+    throw result.error;
+  }
+  return std::move(result.response);
+}
 
-  auto cb = [&](::arangodb::fuerte::v1::Error e,
-                std::unique_ptr<Request> request,
-                std::unique_ptr<Response> response) {
-    WaitGroupDone done(wg);
-    rv = std::move(response);
-    error = e;
-  };
+// sendRequest and wait for it to finished, without exceptions
+RequestResult Connection::sendRequest(std::unique_ptr<Request> request,
+                                      std::nothrow_t) {
+  FUERTE_LOG_TRACE << "sendRequest (sync): before send" << std::endl;
 
-  {
-    // Start asynchronous request
-    wg.add();
-    sendRequest(std::move(request), cb);
+  struct Waiter {
+    RequestResult result;
+    OneShotEvent done;
+  } waiter;
 
-    // Wait for request to finish.
-    FUERTE_LOG_TRACE << "sendRequest (sync): before wait" << std::endl;
-    wg.wait();
-  }
+  // a single pointer capture fits the inline buffer of the RequestHandler
+  sendRequest(std::move(request),
+              [w = &waiter](Error e, std::unique_ptr<Request> req,
+                            std::unique_ptr<Response> res) {
+                w->result.error = e;
+                w->result.request = std::move(req);
+                w->result.response = std::move(res);
+                w->done.set();
+              });
 
+  FUERTE_LOG_TRACE << "sendRequest (sync): before wait" << std::endl;
+  waiter.done.wait();
   FUERTE_LOG_TRACE << "sendRequest (sync): done" << std::endl;
+  return std::move(waiter.result);
+}
 
-  if (error != Error::NoError) {
-    throw error;
+// sendRequest without backpressure, fails the request if the queue is full
+MessageID Connection::sendRequest(std::unique_ptr<Request> request,
+                                  RequestHandler cb) {
+  MessageID mid = trySendRequest(request, cb);
+  if (mid == 0) {
+    FUERTE_LOG_ERROR << "connection queue capacity exceeded\n";
+    failRequest(Error::QueueCapacityExceeded, std::move(request),
+                std::move(cb));
   }
-
-  return rv;
+  return mid;
 }
   
 std::string Connection::endpoint() const {
@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include <fuerte/FuerteLogger.h>
+#include <fuerte/executor.h>
+
+namespace arangodb { namespace fuerte { inline namespace v1 {
+
+struct WorkStealingPool::Shared {
+  struct alignas(64) Worker {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  explicit Shared(std::size_t n)
+      : workers(std::make_unique<Worker[]>(n)),
+        numWorkers(n),
+        next(0),
+        pending(0),
+        sleeping(0),
+        stopping(false) {}
+
+  void post(std::function<void()> task);
+  bool takeTask(std::size_t self, std::function<void()>& task);
+  void run(std::size_t self);
+
+  std::unique_ptr<Worker[]> workers;
+  std::size_t const numWorkers;
+  /// round-robin position for tasks posted from outside
+  std::atomic<std::size_t> next;
+  /// tasks posted but not yet taken
+  std::atomic<std::size_t> pending;
+
+  std::mutex sleepMutex;
+  std::condition_variable sleepCondition;
+  std::atomic<unsigned> sleeping;
+  bool stopping;
+};
+
+namespace {
+/// pool and worker index of the current thread
+thread_local void const* currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+}  // namespace
+
+void WorkStealingPool::Shared::post(std::function<void()> task) {
+  std::size_t target =
+      currentPool == this
+          ? currentWorker
+          : next.fetch_add(1, std::memory_order_relaxed) % numWorkers;
+  {
+    std::lock_guard<std::mutex> guard(workers[target].mutex);
+    workers[target].tasks.push_back(std::move(task));
+  }
+  pending.fetch_add(1);
+  if (sleeping.load() > 0) {
+    // lock pairs with the predicate check of a worker going to sleep
+    { std::lock_guard<std::mutex> guard(sleepMutex); }
+    sleepCondition.notify_one();
+  }
+}
+
+bool WorkStealingPool::Shared::takeTask(std::size_t self,
+                                        std::function<void()>& task) {
+  {
+    Worker& own = workers[self];
+    std::lock_guard<std::mutex> guard(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+  for (std::size_t i = 1; i < numWorkers; i++) {
+    Worker& victim = workers[(self + i) % numWorkers];
+    std::lock_guard<std::mutex> guard(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::Shared::run(std::size_t self) {
+  currentPool = this;
+  currentWorker = self;
+
+  std::function<void()> task;
+  while (true) {
+    if (takeTask(self, task)) {
+      pending.fetch_sub(1);
+      try {
+        task();
+      } catch (std::exception const& e) {
+        FUERTE_LOG_ERROR << "callback threw: " << e.what() << "\n";
+      } catch (...) {
+        FUERTE_LOG_ERROR << "callback threw\n";
+      }
+      task = nullptr;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> guard(sleepMutex);
+    sleeping.fetch_add(1);
+    sleepCondition.wait(guard, [&] { return stopping || pending.load() > 0; });
+    sleeping.fetch_sub(1);
+    if (stopping && pending.load() == 0) {
+      break;
+    }
+  }
+  currentPool = nullptr;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+    : _shared(std::make_shared<Shared>(std::max(threadCount, 1u))) {
+  for (std::size_t i = 0; i < _shared->numWorkers; i++) {
+    _threads.emplace_back([shared = _shared, i] { shared->run(i); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> guard(_shared->sleepMutex);
+    _shared->stopping = true;
+  }
+  _shared->sleepCondition.notify_all();
+  for (std::thread& t : _threads) {
+    if (t.get_id() == std::this_thread::get_id()) {
+      t.detach();  // destroyed by one of our callbacks, it exits by itself
+    } else {
+      t.join();
+    }
+  }
+}
+
+void WorkStealingPool::post(std::function<void()> task) {
+  _shared->post(std::move(task));
+}
+
+}}}  // namespace arangodb::fuerte::v1
@@ -89,7 +89,7 @@ std::string to_string(Message& message) {
     if (!req.header.parameters.empty()) {
       ss << "parameters: ";
       for (auto const& item : req.header.parameters) {
-        ss << item.first << " -:- " << item.second << "\n";
+        ss << item.key() << " -:- " << item.value << "\n";
       }
       ss << std::endl;
     }
@@ -99,7 +99,7 @@ std::string to_string(Message& message) {
       ss << "\t" << fu_content_type_key << " -:- " << to_string(req.header.contentType()) << "\n";
       ss << "\t" << fu_accept_key << " -:- " << to_string(req.header.acceptType()) << "\n";
       for (auto const& item : req.header.meta()) {
-        ss << "\t" << item.first << " -:- " << item.second << "\n";
+        ss << "\t" << item.key() << " -:- " << item.value << "\n";
       }
       ss << std::endl;
     }
@@ -119,7 +119,7 @@ std::string to_string(Message& message) {
       ss << "meta:\n";
       ss << "\t" << fu_content_type_key << " -:- " << to_string(res.header.contentType()) << "\n";
       for (auto const& item : res.header.meta()) {
-        ss << "\t" << item.first << " -:- " << item.second << "\n";
+        ss << "\t" << item.key() << " -:- " << item.value << "\n";
       }
       ss << std::endl;
     }
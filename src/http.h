@@ -26,26 +26,67 @@
 
 #include <fuerte/message.h>
 #include <fuerte/types.h>
+#include <chrono>
 #include <string>
 
+#include "MPSCQueue.h"
+
 namespace arangodb { namespace fuerte { inline namespace v1 { namespace http {
 
 // in-flight request data
-struct RequestItem {
+struct RequestItem : public MPSCQueueHook {
+  /// ID of this request
+  MessageID messageID = 0;
+
   /// the request header
   std::string requestHeader;
 
+  /// header and payload segments, written with a single gather write
+  std::vector<asio_ns::const_buffer> writeBuffers;
+
   /// Callback for when request is done (in error or succeeded)
-  RequestCallback callback;
+  RequestHandler callback;
   
   /// Reference to the request we're processing
   std::unique_ptr<arangodb::fuerte::v1::Request> request;
 
+  /// point in time when the request expires, covers queueing, connecting,
+  /// writing and reading
+  std::chrono::steady_clock::time_point expires;
+
+  /// the request probing an open circuit breaker
+  bool probe = false;
+
+  /// canceled before its response was awaited, it is skipped when
+  /// dequeued or abandoned once written
+  bool canceled = false;
+
   inline void invokeOnError(Error e) {
     callback(e, std::move(request), nullptr);
   }
 };
 
+/// prepare an item for reuse, keeps the capacity of the header string
+inline void poolReset(RequestItem& item) {
+  item.messageID = 0;
+  item.requestHeader.clear();
+  item.writeBuffers.clear();
+  item.callback = nullptr;
+  item.request.reset();
+  item.probe = false;
+  item.canceled = false;
+}
+
+/// a cheap to copy view of a range of buffers, usable as an asio
+/// ConstBufferSequence. The buffers must outlive the write operation.
+struct BufferRange {
+  asio_ns::const_buffer const* first;
+  asio_ns::const_buffer const* last;
+
+  asio_ns::const_buffer const* begin() const { return first; }
+  asio_ns::const_buffer const* end() const { return last; }
+};
+
 /// url-decodes [src, src+len) into out
 void urlDecode(std::string& out, char const* src, size_t len);
 
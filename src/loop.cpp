@@ -22,19 +22,94 @@
 
 #include <memory>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include <fuerte/FuerteLogger.h>
 #include <fuerte/loop.h>
 #include <fuerte/types.h>
 
+#include "Basics/cpu-relax.h"
+#include "CircuitBreaker.h"
+#include "ObjectPools.h"
+#include "ResolverCache.h"
+#include "TlsSessionCache.h"
+
 namespace arangodb { namespace fuerte { inline namespace v1 {
 
-EventLoopService::EventLoopService(unsigned int threadCount)
-  : _lastUsed(0), _sslContext(nullptr) {
-  for (unsigned i = 0; i < threadCount; i++) {
+namespace {
+/// loop service and io_context index of the current thread
+thread_local EventLoopService const* currentLoop = nullptr;
+thread_local int currentIndex = -1;
+
+void pinThread(std::thread& thread, unsigned cpu) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  int res = pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+  if (res != 0) {
+    FUERTE_LOG_ERROR << "unable to pin event loop thread to cpu " << cpu
+                     << ": " << res << "\n";
+  }
+#else
+  FUERTE_LOG_ERROR << "thread affinity is not supported on this platform\n";
+#endif
+}
+
+/// run handlers as soon as they are ready, block only after `budget`
+/// without any work
+void runBusyPoll(asio_ns::io_context& ctx, std::chrono::microseconds budget) {
+  auto idleSince = std::chrono::steady_clock::now();
+  while (!ctx.stopped()) {
+    if (ctx.poll() > 0) {
+      idleSince = std::chrono::steady_clock::now();
+      continue;
+    }
+    if (std::chrono::steady_clock::now() - idleSince < budget) {
+      cpu_relax();
+      continue;
+    }
+    ctx.run_one();  // nothing for a while, wait in the reactor
+    idleSince = std::chrono::steady_clock::now();
+  }
+}
+}  // namespace
+
+EventLoopService::EventLoopService(unsigned int threadCount,
+                                   std::vector<unsigned> const& cpuAffinity)
+  : EventLoopService(LoopOptions{threadCount, cpuAffinity}) {}
+
+EventLoopService::EventLoopService(LoopOptions const& options)
+  : _lastUsed(0),
+    _load(std::make_unique<ContextLoad[]>(options.threadCount)),
+    _memoryBudget(options.memoryBudget),
+    _bufferedBytes(0),
+    _tlsSessionCache(std::make_unique<TlsSessionCache>()),
+    _sslContext(nullptr),
+    _resolverCache(std::make_unique<ResolverCache>()),
+    _pools(std::make_unique<ObjectPools[]>(options.threadCount)) {
+  for (unsigned i = 0; i < options.threadCount; i++) {
     _ioContexts.emplace_back(std::make_shared<asio_ns::io_context>(1));
     _guards.emplace_back(asio_ns::make_work_guard(*_ioContexts.back()));
     asio_ns::io_context* ctx = _ioContexts.back().get();
-    _threads.emplace_back([ctx]() { ctx->run(); });
+    bool busyPoll = i < options.busyPollThreads;
+    _threads.emplace_back([this, ctx, i, busyPoll,
+                           budget = options.spinBudget]() {
+      currentLoop = this;
+      currentIndex = static_cast<int>(i);
+      if (busyPoll) {
+        runBusyPoll(*ctx, budget);
+      } else {
+        ctx->run();
+      }
+    });
+    if (!options.cpuAffinity.empty()) {
+      pinThread(_threads.back(),
+                options.cpuAffinity[i % options.cpuAffinity.size()]);
+    }
   }
 }
 
@@ -49,7 +124,55 @@ EventLoopService::~EventLoopService() {
     ctx->stop();
   }
 }
-  
+
+char const* EventLoopService::backend() {
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT) || \
+    defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+  return "io_uring";
+#elif defined(BOOST_ASIO_HAS_EPOLL) || defined(ASIO_HAS_EPOLL)
+  return "epoll";
+#elif defined(BOOST_ASIO_HAS_KQUEUE) || defined(ASIO_HAS_KQUEUE)
+  return "kqueue";
+#elif defined(BOOST_ASIO_HAS_IOCP) || defined(ASIO_HAS_IOCP)
+  return "iocp";
+#else
+  return "select";
+#endif
+}
+
+int EventLoopService::currentIOContext() const {
+  return currentLoop == this ? currentIndex : -1;
+}
+
+std::size_t EventLoopService::acquireIOContext(int hint) {
+  std::size_t index = hint >= 0
+                          ? static_cast<std::size_t>(hint) % _ioContexts.size()
+                          : leastLoaded();
+  _load[index].connections.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+ObjectPools& EventLoopService::objectPools(std::size_t index) {
+  return _pools[index % _ioContexts.size()];
+}
+
+std::size_t EventLoopService::leastLoaded() {
+  std::size_t const n = _ioContexts.size();
+  std::size_t const start =
+      _lastUsed.fetch_add(1, std::memory_order_relaxed) % n;
+  std::size_t best = start;
+  uint32_t bestLoad = load(start);
+  for (std::size_t i = 1; i < n && bestLoad > 0; i++) {
+    std::size_t idx = (start + i) % n;
+    uint32_t l = load(idx);
+    if (l < bestLoad) {
+      best = idx;
+      bestLoad = l;
+    }
+  }
+  return best;
+}
+
 asio_ns::ssl::context& EventLoopService::sslContext() {
   std::lock_guard<std::mutex> guard(_sslContextMutex);
   if (!_sslContext) {
@@ -59,8 +182,26 @@ asio_ns::ssl::context& EventLoopService::sslContext() {
     _sslContext.reset(new asio_ns::ssl::context(asio_ns::ssl::context::sslv23));
 #endif
     _sslContext->set_default_verify_paths();
+    _tlsSessionCache->attach(*_sslContext);
   }
   return *_sslContext;
 }
+
+std::shared_ptr<CircuitBreaker> EventLoopService::circuitBreaker(
+    std::string const& endpoint, detail::ConnectionConfiguration const& conf) {
+  // connections with different breaker settings do not share one
+  std::string key = endpoint;
+  key.append("|").append(std::to_string(conf._breakerFailureRatio));
+  key.append("|").append(std::to_string(conf._breakerMinRequests));
+  key.append("|").append(std::to_string(conf._breakerWindow.count()));
+  key.append("|").append(std::to_string(conf._breakerOpenTimeout.count()));
+
+  std::lock_guard<std::mutex> guard(_breakerMutex);
+  auto& breaker = _breakers[key];
+  if (!breaker) {
+    breaker = std::make_shared<CircuitBreaker>(conf);
+  }
+  return breaker;
+}
   
 }}}  // namespace arangodb::fuerte::v1
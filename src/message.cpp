@@ -25,6 +25,8 @@
 
 #include <velocypack/Validator.h>
 #include <velocypack/velocypack-aliases.h>
+#include <atomic>
+#include <cstring>
 #include <sstream>
 
 #include <iostream>
@@ -41,7 +43,7 @@ void MessageHeader::setMeta(StringMap map) {
       this->addMeta(pair.first, pair.second);
     }
   } else {
-    this->_meta = std::move(map);
+    this->_meta = HeaderMap(map);
   }
 }
 
@@ -53,13 +55,13 @@ std::string const& MessageHeader::metaByKey(std::string const& key,
     found = false;
     return emptyString;
   }
-  auto const& it = _meta.find(key);
-  if (it == _meta.end()) {
+  HeaderMap::Entry const* e = _meta.find(key);
+  if (e == nullptr) {
     found = false;
     return emptyString;
   } else {
     found = true;
-    return it->second;
+    return e->value;
   }
 }
 
@@ -73,7 +75,7 @@ void RequestHeader::acceptType(std::string const& type) {
 
 void RequestHeader::addParameter(std::string const& key,
                                  std::string const& value) {
-  parameters.try_emplace(key, value);
+  parameters.emplace(key, value);
 }
 
 /// @brief analyze path and split into components
@@ -163,7 +165,7 @@ void Request::addVPack(VPackSlice const slice) {
 #endif
 
   header.contentType(ContentType::VPack);
-  _payload.append(slice.start(), slice.byteSize());
+  addBinary(slice.start(), slice.byteSize());
 }
 
 void Request::addVPack(VPackBuffer<uint8_t> const& buffer) {
@@ -173,7 +175,7 @@ void Request::addVPack(VPackBuffer<uint8_t> const& buffer) {
   vst::parser::validateAndCount(buffer.data(), buffer.byteSize());
 #endif
   header.contentType(ContentType::VPack);
-  _payload.append(buffer);
+  addBinary(buffer.data(), buffer.byteSize());
 }
 
 void Request::addVPack(VPackBuffer<uint8_t>&& buffer) {
@@ -183,20 +185,41 @@ void Request::addVPack(VPackBuffer<uint8_t>&& buffer) {
   vst::parser::validateAndCount(buffer.data(), buffer.byteSize());
 #endif
   header.contentType(ContentType::VPack);
-  _payload = std::move(buffer);
+  if (_segments.empty()) {
+    _payload = std::move(buffer);
+    _flat.buffer.reset();
+  } else {  // keep the order, the buffer becomes the next segment
+    addSegment(PayloadSlice(
+        std::make_shared<VPackBuffer<uint8_t>>(std::move(buffer))));
+  }
 }
 
 // add binary data
 void Request::addBinary(uint8_t const* data, std::size_t length) {
-  _payload.append(data, length);
+  if (_segments.empty()) {
+    _payload.append(data, length);
+    _flat.buffer.reset();
+  } else {  // keep the order, the bytes become the next segment
+    auto buffer = std::make_shared<VPackBuffer<uint8_t>>();
+    buffer->append(data, length);
+    addSegment(PayloadSlice(std::move(buffer)));
+  }
+}
+
+void Request::addSegment(PayloadSlice segment) {
+  if (!segment.empty()) {
+    _segments.emplace_back(std::move(segment));
+    _flat.buffer.reset();
+  }
 }
 
 // get payload as slices
 std::vector<VPackSlice> Request::slices() const {
   std::vector<VPackSlice> slices;
   if (isContentTypeVPack()) {
-    auto length = _payload.byteSize();
-    auto cursor = _payload.data();
+    asio_ns::const_buffer p = payload();
+    auto length = p.size();
+    auto cursor = static_cast<uint8_t const*>(p.data());
     while (length) {
       slices.emplace_back(cursor);
       auto sliceSize = slices.back().byteSize();
@@ -212,10 +235,45 @@ std::vector<VPackSlice> Request::slices() const {
 
 // get payload as binary
 asio_ns::const_buffer Request::payload() const {
-  return asio_ns::const_buffer(_payload.data(), _payload.byteSize());
+  if (_segments.empty()) {
+    return asio_ns::const_buffer(_payload.data(), _payload.byteSize());
+  }
+  // const readers may race here, the first published copy wins and the
+  // others are dropped
+  auto flat =
+      std::atomic_load_explicit(&_flat.buffer, std::memory_order_acquire);
+  if (!flat) {
+    auto copy = std::make_shared<VPackBuffer<uint8_t>>();
+    copy->reserve(payloadSize());
+    copy->append(_payload.data(), _payload.byteSize());
+    for (PayloadSlice const& segment : _segments) {
+      copy->append(segment.data(), segment.size());
+    }
+    if (std::atomic_compare_exchange_strong_explicit(
+            &_flat.buffer, &flat, copy, std::memory_order_acq_rel,
+            std::memory_order_acquire)) {
+      flat = std::move(copy);
+    }
+  }
+  return asio_ns::const_buffer(flat->data(), flat->byteSize());
 }
 
-size_t Request::payloadSize() const { return _payload.byteSize(); }
+size_t Request::payloadSize() const {
+  std::size_t size = _payload.byteSize();
+  for (PayloadSlice const& segment : _segments) {
+    size += segment.size();
+  }
+  return size;
+}
+
+void Request::payloadBuffers(std::vector<asio_ns::const_buffer>& out) const {
+  if (_payload.byteSize() > 0) {
+    out.emplace_back(_payload.data(), _payload.byteSize());
+  }
+  for (PayloadSlice const& segment : _segments) {
+    out.emplace_back(segment.buffer());
+  }
+}
 
 ///////////////////////////////////////////////
 // class Response
@@ -226,8 +284,9 @@ std::vector<VPackSlice> Response::slices() const {
   if (isContentTypeVPack()) {
     VPackValidator validator;
 
-    auto length = _payload.byteSize() - _payloadOffset;
-    auto cursor = _payload.data() + _payloadOffset;
+    asio_ns::const_buffer p = payload();
+    auto length = p.size();
+    auto cursor = static_cast<uint8_t const*>(p.data());
     while (length) {
       // will throw on an error
       validator.validate(cursor, length, true);
@@ -245,31 +304,61 @@ std::vector<VPackSlice> Response::slices() const {
 }
 
 asio_ns::const_buffer Response::payload() const {
-  return asio_ns::const_buffer(_payload.data() + _payloadOffset,
-                               _payload.byteSize() - _payloadOffset);
+  if (!_allocated.empty()) {
+    return _allocated.buffer();
+  }
+  return asio_ns::const_buffer(buffer().data() + _payloadOffset,
+                               buffer().byteSize() - _payloadOffset);
 }
 
 size_t Response::payloadSize() const {
-  return _payload.byteSize() - _payloadOffset;
+  if (!_allocated.empty()) {
+    return _allocated.size();
+  }
+  return buffer().byteSize() - _payloadOffset;
 }
 
 std::shared_ptr<velocypack::Buffer<uint8_t>> Response::copyPayload() const {
-  auto buffer = std::make_shared<velocypack::Buffer<uint8_t>>();
-  buffer->append(_payload.data() + _payloadOffset,
-                 _payload.byteSize() - _payloadOffset);
-  return buffer;
+  auto copy = std::make_shared<velocypack::Buffer<uint8_t>>();
+  asio_ns::const_buffer p = payload();
+  copy->append(static_cast<uint8_t const*>(p.data()), p.size());
+  return copy;
 }
 
 std::shared_ptr<velocypack::Buffer<uint8_t>> Response::stealPayload() {
-  if (_payloadOffset == 0) {
-    return std::make_shared<velocypack::Buffer<uint8_t>>(std::move(_payload));
+  if ((_sharedPayload && _sharedPayload.use_count() > 1) ||
+      !_allocated.empty()) {
+    // still viewed through PayloadSlices or not in a velocypack buffer,
+    // leave the bytes alone
+    auto copy = copyPayload();
+    setPayload(velocypack::Buffer<uint8_t>(), 0);
+    return copy;
   }
 
-  auto buffer = std::make_shared<velocypack::Buffer<uint8_t>>();
-  buffer->append(_payload.data() + _payloadOffset,
-                 _payload.byteSize() - _payloadOffset);
-  _payload.clear();
-  _payloadOffset = 0;
-  return buffer;
+  auto result = std::move(_sharedPayload);
+  if (!result) {
+    result =
+        std::make_shared<velocypack::Buffer<uint8_t>>(std::move(_payload));
+  }
+  if (_payloadOffset != 0) {  // drop the prefix in place, no new buffer
+    std::size_t size = result->byteSize() - _payloadOffset;
+    std::memmove(result->data(), result->data() + _payloadOffset, size);
+    result->resetTo(size);
+  }
+  setPayload(velocypack::Buffer<uint8_t>(), 0);
+  return result;
+}
+
+PayloadSlice Response::sharePayload() {
+  if (!_allocated.empty()) {
+    return _allocated;
+  }
+  if (!_sharedPayload) {
+    _sharedPayload =
+        std::make_shared<velocypack::Buffer<uint8_t>>(std::move(_payload));
+    _payload.clear();
+  }
+  return PayloadSlice(_sharedPayload, _payloadOffset,
+                      _sharedPayload->byteSize() - _payloadOffset);
 }
 }}}  // namespace arangodb::fuerte::v1
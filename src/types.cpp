@@ -213,6 +213,50 @@ std::string to_string(ContentType type) {
   throw std::logic_error("unknown content type");
 }
 
+namespace {
+// indexed by HeaderId
+constexpr std::string_view headerNames[] = {
+    "",
+    "accept",
+    "authorization",
+    "connection",
+    "content-encoding",
+    "content-length",
+    "content-type",
+    "etag",
+    "keep-alive",
+    "location",
+    "server",
+    "transfer-encoding",
+    "www-authenticate",
+    "x-arango-async-id",
+    "x-arango-endpoint",
+    "x-arango-errors",
+    "x-arango-queue-time-seconds",
+    "x-arango-trx-id",
+    "x-arango-version"};
+constexpr std::size_t numHeaderNames =
+    sizeof(headerNames) / sizeof(headerNames[0]);
+static_assert(numHeaderNames ==
+                  static_cast<std::size_t>(HeaderId::XArangoVersion) + 1,
+              "every HeaderId needs a name");
+}  // namespace
+
+HeaderId toHeaderId(std::string_view name) {
+  // most names differ in length or in the first characters already
+  for (std::size_t i = 1; i < numHeaderNames; i++) {
+    if (headerNames[i].size() == name.size() && headerNames[i] == name) {
+      return static_cast<HeaderId>(i);
+    }
+  }
+  return HeaderId::Custom;
+}
+
+std::string_view headerName(HeaderId id) {
+  auto i = static_cast<std::size_t>(id);
+  return i < numHeaderNames ? headerNames[i] : std::string_view();
+}
+
 std::string to_string(AuthenticationType type) {
   switch (type) {
     case AuthenticationType::None:
@@ -239,12 +283,18 @@ std::string to_string(Error error) {
       return "Request timeout";
     case Error::QueueCapacityExceeded:
       return "Request queue capacity exceeded";
+    case Error::CircuitOpen:
+      return "Endpoint unavailable, circuit breaker is open";
     case Error::ReadError:
       return "Error while reading";
     case Error::WriteError:
       return "Error while writing";
     case Error::Canceled:
       return "Connection was locally canceled";
+    case Error::ResponseTooLarge:
+      return "Response exceeds the maximum response size";
+    case Error::MemoryBudgetExceeded:
+      return "Response exceeds the memory budget";
       
     case Error::VstUnauthorized:
       return "Cannot authorize on VST connection";
@@ -102,7 +102,8 @@ size_t ChunkHeader::writeHeaderToVST1_1(size_t chunkDataLen,
 
 /// @brief creates a slice containing a VST request-message header.
 void message::requestHeader(RequestHeader const& header,
-                            VPackBuffer<uint8_t>& buffer) {
+                            VPackBuffer<uint8_t>& buffer,
+                            StringMap const* extraMeta) {
   VPackBuilder builder(buffer);
 
   assert(builder.isClosed());
@@ -143,7 +144,8 @@ void message::requestHeader(RequestHeader const& header,
   if (!header.parameters.empty()) {
     VPackObjectBuilder guard(&builder);
     for (auto const& item : header.parameters) {
-      builder.add(item.first, VPackValue(item.second));
+      std::string_view key = item.key();
+      builder.add(key.data(), key.size(), VPackValue(item.value));
     }
   } else {
     builder.add(VPackSlice::emptyObjectSlice());
@@ -160,7 +162,13 @@ void message::requestHeader(RequestHeader const& header,
                   VPackValue(to_string(header.contentType())));
     }
     for (auto const& pair : header.meta()) {  // iequals for data from server
-      builder.add(pair.first, VPackValue(pair.second));
+      std::string_view key = pair.key();
+      builder.add(key.data(), key.size(), VPackValue(pair.value));
+    }
+    if (extraMeta != nullptr) {
+      for (auto const& pair : *extraMeta) {
+        builder.add(pair.first, VPackValue(pair.second));
+      }
     }
   }
   builder.close();  // </array>
@@ -196,10 +204,11 @@ void message::responseHeader(ResponseHeader const& header,
               VPackValue(to_string(header.contentType())));
   if (!header.meta().empty()) {
     for (auto const& pair : header.meta()) {
-      if (boost::iequals(fu_content_type_key, pair.first)) {
+      std::string_view key = pair.key();
+      if (boost::iequals(fu_content_type_key, key)) {
          continue;
        }
-      builder.add(pair.first, VPackValue(pair.second));
+      builder.add(key.data(), key.size(), VPackValue(pair.value));
     }
   }
   builder.close();
@@ -239,10 +248,30 @@ void message::authBasic(std::string const& username,
 void message::prepareForNetwork(VSTVersion vstVersion, MessageID messageId,
                                 VPackBuffer<uint8_t>& buffer,
                                 asio_ns::const_buffer payload,
-                                std::vector<asio_ns::const_buffer>& result) {
+                                std::vector<asio_ns::const_buffer>& result,
+                                std::vector<std::size_t>* chunkStarts) {
+  std::vector<asio_ns::const_buffer> segments;
+  if (payload.size() > 0) {
+    segments.emplace_back(payload);
+  }
+  prepareForNetwork(vstVersion, messageId, buffer, segments, result,
+                    chunkStarts);
+}
+
+/// @brief same as above, but the payload is a sequence of segments which
+///        are referenced in place, a chunk may span several of them
+void message::prepareForNetwork(
+    VSTVersion vstVersion, MessageID messageId, VPackBuffer<uint8_t>& buffer,
+    std::vector<asio_ns::const_buffer> const& payload,
+    std::vector<asio_ns::const_buffer>& result,
+    std::vector<std::size_t>* chunkStarts) {
   // Split message into chunks
   // we assume that the message header is already in the buffer
-  size_t msgLength = buffer.size() + payload.size();
+  size_t payloadLength = 0;
+  for (asio_ns::const_buffer const& segment : payload) {
+    payloadLength += segment.size();
+  }
+  size_t msgLength = buffer.size() + payloadLength;
   assert(msgLength > 0);
 
   // builds a list of chunks that are ready to be sent to the server.
@@ -259,14 +288,15 @@ void message::prepareForNetwork(VSTVersion vstVersion, MessageID messageId,
   buffer.reserve(spaceNeeded);
 
   asio_ns::const_buffer header(buffer.data(), buffer.size());
-  result.reserve((2 * numChunks) + 1);
+  // every segment boundary inside a chunk costs one extra data buffer
+  result.reserve((2 * numChunks) + payload.size() + 1);
+  if (chunkStarts != nullptr) {
+    chunkStarts->reserve(numChunks);
+  }
 
   uint32_t chunkIndex = 0;
-  uint8_t const* begin = reinterpret_cast<uint8_t const*>(payload.data());
-#ifdef FUERTE_DEBUG
-  uint8_t const* end =
-      reinterpret_cast<uint8_t const*>(payload.data()) + payload.size();
-#endif
+  size_t segment = 0;        // current payload segment
+  size_t segmentOffset = 0;  // bytes of it already placed in chunks
 
   size_t remaining = msgLength;
   while (remaining > 0) {
@@ -297,20 +327,30 @@ void message::prepareForNetwork(VSTVersion vstVersion, MessageID messageId,
     assert(chunkHdrLen > 0 && chunkHdrLen <= maxChunkHeaderSize);
 
     // Add chunk buffer
+    if (chunkStarts != nullptr) {
+      chunkStarts->push_back(result.size());
+    }
     result.emplace_back(buffer.data() + chunkOffset, chunkHdrLen);
     if (chunkIndex == 0) {  // stuff in message header
       assert(header.size() <= chunkDataLen);
       result.emplace_back(header);
       chunkDataLen -= header.size();
     }
-    if (chunkDataLen > 0) {
-      assert(payload.size() > 0);
-#ifdef FUERTE_DEBUG
-      assert(begin < end);
-#endif
+    while (chunkDataLen > 0) {
+      assert(segment < payload.size());
+      size_t available = payload[segment].size() - segmentOffset;
+      if (available == 0) {  // skip empty segments
+        segment++;
+        segmentOffset = 0;
+        continue;
+      }
       // Add chunk data buffer
-      result.emplace_back(begin, chunkDataLen);
-      begin += chunkDataLen;
+      size_t len = std::min(available, chunkDataLen);
+      result.emplace_back(reinterpret_cast<uint8_t const*>(
+                              payload[segment].data()) + segmentOffset,
+                          len);
+      segmentOffset += len;
+      chunkDataLen -= len;
     }
 
     chunkIndex++;
@@ -323,8 +363,8 @@ void message::prepareForNetwork(VSTVersion vstVersion, MessageID messageId,
 
 // prepareForNetwork prepares the internal structures for
 // writing the request to the network.
-std::vector<asio_ns::const_buffer> RequestItem::prepareForNetwork(
-    VSTVersion vstVersion) {
+void RequestItem::prepareForNetwork(VSTVersion vstVersion,
+                                    StringMap const* extraMeta) {
   // setting defaults
   _request->header.setVersion(1);  // always set to 1
   if (_request->header.database.empty()) {
@@ -333,15 +373,32 @@ std::vector<asio_ns::const_buffer> RequestItem::prepareForNetwork(
 
   // Create the message header and store it in the metadata buffer
   _buffer.clear();
-  message::requestHeader(_request->header, _buffer);
+  message::requestHeader(_request->header, _buffer, extraMeta);
   assert(_buffer.size() > 0);
-  // message header has to go into the first chunk
-  asio_ns::const_buffer payload = _request->payload();
+  // message header has to go into the first chunk, the payload segments
+  // are referenced in place
+  _payloadBuffers.clear();
+  _request->payloadBuffers(_payloadBuffers);
 
   // _buffer content will be used as message header
-  std::vector<asio_ns::const_buffer> result;
-  message::prepareForNetwork(vstVersion, _messageID, _buffer, payload, result);
-  return result;
+  _sendBuffers.clear();
+  _chunkStarts.clear();
+  _nextChunk = 0;
+  message::prepareForNetwork(vstVersion, _messageID, _buffer,
+                             _payloadBuffers, _sendBuffers, &_chunkStarts);
+}
+
+// buffers of the next `maxChunks` unsent chunks
+std::vector<asio_ns::const_buffer> RequestItem::nextChunks(
+    std::size_t maxChunks) {
+  assert(_nextChunk < _chunkStarts.size());
+  std::size_t last = std::min(_nextChunk + maxChunks, _chunkStarts.size());
+  auto begin = _sendBuffers.begin() + _chunkStarts[_nextChunk];
+  auto end = last < _chunkStarts.size()
+                 ? _sendBuffers.begin() + _chunkStarts[last]
+                 : _sendBuffers.end();
+  _nextChunk = last;
+  return std::vector<asio_ns::const_buffer>(begin, end);
 }
 
 namespace parser {
@@ -582,6 +639,16 @@ void RequestItem::addChunk(Chunk const& chunk) {
       ChunkInfo{chunk.header.index(), offset, chunk.body.size()});
 }
 
+asio_ns::mutable_buffer RequestItem::addPartialChunk(Chunk const& chunk,
+                                                    std::size_t bodyLength) {
+  assert(chunk.body.size() < bodyLength);
+  addChunk(chunk);
+  _responseChunks.back().size = bodyLength;
+  std::size_t missing = bodyLength - chunk.body.size();
+  _buffer.reserve(missing);
+  return asio_ns::mutable_buffer(_buffer.data() + _buffer.size(), missing);
+}
+
 static bool chunkByIndex(const RequestItem::ChunkInfo& a,
                          const RequestItem::ChunkInfo& b) {
   return (a.index < b.index);
@@ -26,10 +26,12 @@
 
 #include <fuerte/detail/vst.h>
 
+#include "MPSCQueue.h"
+
 namespace arangodb { namespace fuerte { inline namespace v1 { namespace vst {
 
 // Item that represents a Request in flight
-struct RequestItem {
+struct RequestItem : public MPSCQueueHook {
   /// Buffer used to store data for request and response
   /// For request holds chunk headers and message header
   /// For responses contains contents of received chunks.
@@ -46,10 +48,12 @@ struct RequestItem {
   std::vector<ChunkInfo> _responseChunks;
   
   /// Callback for when request is done (in error or succeeded)
-  RequestCallback _callback;
+  RequestHandler _callback;
   
   /// The number of chunks we're expecting (0==not know yet).
   size_t _responseNumberOfChunks = 0;
+  /// response bytes accounted for by the connection
+  size_t _chargedBytes = 0;
   
   /// ID of this message
   MessageID _messageID;
@@ -58,6 +62,22 @@ struct RequestItem {
 
   /// point in time when the message expires
   std::chrono::steady_clock::time_point _expires;
+
+  /// chunk buffers of the request, point into _buffer and the payload
+  std::vector<asio_ns::const_buffer> _sendBuffers;
+  /// index in _sendBuffers where each chunk begins
+  std::vector<std::size_t> _chunkStarts;
+  /// payload segments of the request, referenced by _sendBuffers
+  std::vector<asio_ns::const_buffer> _payloadBuffers;
+  /// next chunk to send
+  std::size_t _nextChunk = 0;
+  /// a write of this request is in progress
+  bool _sending = false;
+  /// failed while queued or during a write, the callback gets this error
+  /// once the request is dequeued or the write is done
+  Error _pendingError = Error::NoError;
+  /// the request probing an open circuit breaker
+  bool _probe = false;
   
  public:
   
@@ -68,10 +88,30 @@ struct RequestItem {
 
   /// prepareForNetwork prepares the internal structures for
   /// writing the request to the network.
-  std::vector<asio_ns::const_buffer> prepareForNetwork(VSTVersion);
+  void prepareForNetwork(VSTVersion, StringMap const* extraMeta = nullptr);
+
+  /// number of chunks the request was split into
+  inline std::size_t numChunks() const { return _chunkStarts.size(); }
+  /// buffers of the next chunks to send, at most `maxChunks`
+  std::vector<asio_ns::const_buffer> nextChunks(std::size_t maxChunks);
+  /// true if all chunks were handed out by nextChunks()
+  inline bool sendComplete() const {
+    return _nextChunk >= _chunkStarts.size();
+  }
+  /// a write is in progress or only some chunks were written. The server
+  /// has seen part of the message, all of it must go out before anything
+  /// fails the request locally, and the request must stay alive until then.
+  inline bool writeStarted() const {
+    return _sending || (_nextChunk > 0 && !sendComplete());
+  }
   
   // add the given chunk to the list of response chunks.
   void addChunk(Chunk const& chunk);
+  // add a chunk of which only the start of the body was received yet,
+  // returns the space in _buffer where the rest of it has to be read to.
+  // Call _buffer.advance() for the bytes read there.
+  asio_ns::mutable_buffer addPartialChunk(Chunk const& chunk,
+                                          std::size_t bodyLength);
   // try to assembly the received chunks into a response.
   // returns NULL if not all chunks are available.
   std::unique_ptr<velocypack::Buffer<uint8_t>> assemble();
@@ -79,8 +119,30 @@ struct RequestItem {
   // Flush all memory needed for sending this request.
   inline void resetSendData() {
     _buffer.clear();
+    _sendBuffers.clear();
+    _chunkStarts.clear();
+    _payloadBuffers.clear();
+    _nextChunk = 0;
   }
 };
 
+/// prepare an item for reuse, keeps the capacity of its buffers
+inline void poolReset(RequestItem& item) {
+  item._buffer.reset();
+  item._sendBuffers.clear();
+  item._chunkStarts.clear();
+  item._payloadBuffers.clear();
+  item._nextChunk = 0;
+  item._responseChunks.clear();
+  item._chargedBytes = 0;
+  item._callback = nullptr;
+  item._responseNumberOfChunks = 0;
+  item._messageID = 0;
+  item._request.reset();
+  item._sending = false;
+  item._pendingError = Error::NoError;
+  item._probe = false;
+}
+
 }}}}  // namespace arangodb::fuerte::v1::vst
 #endif
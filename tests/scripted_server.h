@@ -0,0 +1,301 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <fuerte/detail/vst.h>
+#include <fuerte/fuerte.h>
+#include <velocypack/Builder.h>
+#include <velocypack/velocypack-aliases.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace f = ::arangodb::fuerte;
+
+// answers the n-th request it receives, on any connection, with the bytes
+// of responses[n], which gets the message ID of the request (VST only).
+// With a `sliceSize` the responses are written in slices of that many
+// bytes, `pause` apart, so the client needs several reads for them.
+// The server also tracks VST messages of which only some chunks arrived.
+class ScriptedServer {
+ public:
+  using Response = std::function<std::string(uint64_t messageID)>;
+
+  ScriptedServer(f::ProtocolType protocol, std::vector<Response> responses,
+                 std::size_t sliceSize = 0,
+                 std::chrono::milliseconds pause = {})
+      : _protocol(protocol),
+        _responses(std::move(responses)),
+        _sliceSize(sliceSize),
+        _pause(pause),
+        _acceptor(_io, asio_ns::ip::tcp::endpoint(
+                           asio_ns::ip::make_address("127.0.0.1"), 0)),
+        _work(asio_ns::make_work_guard(_io)) {
+    accept();
+    _thread = std::thread([this] { _io.run(); });
+  }
+
+  ~ScriptedServer() {
+    asio_ns::post(_io, [this] {
+      _acceptor.close();
+      _work.reset();
+      _io.stop();
+    });
+    _thread.join();
+  }
+
+  /// VST messages whose first chunk arrived, but not all the others
+  std::size_t incompleteMessages() const { return _incomplete.load(); }
+
+  std::string endpoint() const {
+    return std::string(_protocol == f::ProtocolType::Vst ? "vst" : "http") +
+           "://127.0.0.1:" + std::to_string(_acceptor.local_endpoint().port());
+  }
+
+ private:
+  struct Session {
+    explicit Session(asio_ns::io_context& io) : socket(io), timer(io) {}
+    asio_ns::ip::tcp::socket socket;
+    asio_ns::streambuf buffer;
+    std::string chunk;
+    std::deque<std::string> responses;  // not written yet, in order
+    std::map<uint64_t, uint32_t> missingChunks;  // by message ID
+    std::size_t written = 0;            // of responses.front()
+    asio_ns::steady_timer timer;
+  };
+
+  void accept() {
+    auto s = std::make_shared<Session>(_io);
+    _acceptor.async_accept(s->socket,
+                           [this, s](asio_ns::error_code const& ec) {
+                             if (ec) {
+                               return;
+                             }
+                             if (_protocol == f::ProtocolType::Vst) {
+                               readPreamble(s);
+                             } else {
+                               readHttp(s);
+                             }
+                             accept();
+                           });
+  }
+
+  void readHttp(std::shared_ptr<Session> s) {
+    asio_ns::async_read_until(
+        s->socket, s->buffer, "\r\n\r\n",
+        [this, s](asio_ns::error_code const& ec, size_t n) {
+          if (!ec) {
+            s->buffer.consume(n);
+            respond(s, 0);
+            readHttp(s);
+          }
+        });
+  }
+
+  void readPreamble(std::shared_ptr<Session> s) {
+    s->chunk.resize(std::strlen("VST/1.1\r\n\r\n"));
+    asio_ns::async_read(s->socket, asio_ns::buffer(&s->chunk[0],
+                                                   s->chunk.size()),
+                        [this, s](asio_ns::error_code const& ec, size_t) {
+                          if (!ec) {
+                            readChunk(s);
+                          }
+                        });
+  }
+
+  // answers the first chunk of every message right away, the others are
+  // just read
+  void readChunk(std::shared_ptr<Session> s) {
+    s->chunk.resize(sizeof(uint32_t));
+    asio_ns::async_read(
+        s->socket, asio_ns::buffer(&s->chunk[0], s->chunk.size()),
+        [this, s](asio_ns::error_code const& ec, size_t) {
+          if (ec) {
+            return;
+          }
+          uint32_t length;
+          std::memcpy(&length, s->chunk.data(), sizeof(length));
+          s->chunk.resize(length);
+          asio_ns::async_read(
+              s->socket,
+              asio_ns::buffer(&s->chunk[sizeof(length)],
+                              length - sizeof(length)),
+              [this, s](asio_ns::error_code const& ec, size_t) {
+                if (ec) {
+                  return;
+                }
+                uint32_t chunkX;
+                uint64_t messageID;
+                std::memcpy(&chunkX, s->chunk.data() + 4, sizeof(chunkX));
+                std::memcpy(&messageID, s->chunk.data() + 8,
+                            sizeof(messageID));
+                if (chunkX & 1) {
+                  if ((chunkX >> 1) > 1) {
+                    s->missingChunks[messageID] = (chunkX >> 1) - 1;
+                    _incomplete++;
+                  }
+                  respond(s, messageID);
+                } else {
+                  auto it = s->missingChunks.find(messageID);
+                  if (it != s->missingChunks.end() && --it->second == 0) {
+                    s->missingChunks.erase(it);
+                    _incomplete--;
+                  }
+                }
+                readChunk(s);
+              });
+        });
+  }
+
+  void respond(std::shared_ptr<Session> s, uint64_t messageID) {
+    if (_next >= _responses.size()) {
+      return;
+    }
+    s->responses.push_back(_responses[_next++](messageID));
+    if (s->responses.size() == 1) {
+      write(s);
+    }
+  }
+
+  void write(std::shared_ptr<Session> s) {
+    std::string const& response = s->responses.front();
+    std::size_t n = response.size() - s->written;
+    if (_sliceSize > 0) {
+      n = std::min(n, _sliceSize);
+    }
+    asio_ns::async_write(
+        s->socket, asio_ns::buffer(response.data() + s->written, n),
+        [this, s](asio_ns::error_code const& ec, size_t n) {
+          if (ec) {
+            return;
+          }
+          s->written += n;
+          if (s->written == s->responses.front().size()) {
+            s->responses.pop_front();
+            s->written = 0;
+            if (s->responses.empty()) {
+              return;
+            }
+          }
+          if (_pause.count() == 0) {
+            write(s);
+            return;
+          }
+          s->timer.expires_after(_pause);
+          s->timer.async_wait([this, s](asio_ns::error_code const& ec) {
+            if (!ec) {
+              write(s);
+            }
+          });
+        });
+  }
+
+  f::ProtocolType const _protocol;
+  std::vector<Response> const _responses;
+  std::size_t const _sliceSize;
+  std::chrono::milliseconds const _pause;
+  std::size_t _next = 0;
+  std::atomic<std::size_t> _incomplete{0};
+  asio_ns::io_context _io;
+  asio_ns::ip::tcp::acceptor _acceptor;
+  asio_ns::executor_work_guard<asio_ns::io_context::executor_type> _work;
+  std::thread _thread;
+};
+
+inline ScriptedServer::Response httpResponse(std::string const& body) {
+  return [body](uint64_t) {
+    return "HTTP/1.1 200 OK\r\nContent-Length: " +
+           std::to_string(body.size()) + "\r\n\r\n" + body;
+  };
+}
+
+inline ScriptedServer::Response httpChunkedResponse(
+    std::vector<std::string> const& chunks) {
+  return [chunks](uint64_t) {
+    std::string response =
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+    for (std::string const& chunk : chunks) {
+      char size[16];
+      snprintf(size, sizeof(size), "%zx\r\n", chunk.size());
+      response.append(size).append(chunk).append("\r\n");
+    }
+    return response.append("0\r\n\r\n");
+  };
+}
+
+inline VPackBuffer<uint8_t> vstResponseHeader() {
+  VPackBuffer<uint8_t> buffer;
+  VPackBuilder builder(buffer);
+  builder.openArray();
+  builder.add(VPackValue(1));  // version
+  builder.add(VPackValue(static_cast<int>(f::MessageType::Response)));
+  builder.add(VPackValue(static_cast<int>(f::StatusOK)));
+  builder.openObject();
+  builder.add("content-type", VPackValue("text/plain"));
+  builder.close();
+  builder.close();
+  return buffer;
+}
+
+inline std::string vstMessage(f::vst::VSTVersion version,
+                              uint64_t messageID, std::string const& body) {
+  VPackBuffer<uint8_t> buffer = vstResponseHeader();
+  std::vector<asio_ns::const_buffer> chunks;
+  f::vst::message::prepareForNetwork(version, messageID, buffer,
+                                     asio_ns::buffer(body), chunks);
+  std::string message;
+  for (auto const& chunk : chunks) {
+    message.append(static_cast<char const*>(chunk.data()), chunk.size());
+  }
+  return message;
+}
+
+inline ScriptedServer::Response vstResponse(f::vst::VSTVersion version,
+                                            std::string const& body) {
+  return [version, body](uint64_t messageID) {
+    return vstMessage(version, messageID, body);
+  };
+}
+
+// the whole message in a single VST 1.1 chunk, however large it is
+inline std::string vstSingleChunk(uint64_t messageID,
+                                  std::string const& body) {
+  VPackBuffer<uint8_t> header = vstResponseHeader();
+  f::vst::ChunkHeader chunk{};
+  chunk._chunkX = 3;  // first chunk of 1
+  chunk._messageID = messageID;
+  chunk._messageLength = header.size() + body.size();
+  VPackBuffer<uint8_t> buffer;
+  chunk.writeHeaderToVST1_1(chunk._messageLength, buffer);
+  std::string message(reinterpret_cast<char const*>(buffer.data()),
+                      buffer.size());
+  message.append(reinterpret_cast<char const*>(header.data()), header.size());
+  return message.append(body);
+}
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+#include "scripted_server.h"
+
+#include <fuerte/fuerte.h>
+#include <fuerte/loop.h>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace f = ::arangodb::fuerte;
+
+// canceling a request that finished already does not undo the cancel of
+// a queued one
+TEST(CancelTest, QueuedThenFinished) {
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  ScriptedServer slow(f::ProtocolType::Http,
+                      {[released](uint64_t) {
+                         released.wait();  // keeps the next one queued
+                         return httpResponse("a")(0);
+                       },
+                       httpResponse("b")});
+  ScriptedServer fast(f::ProtocolType::Http, {httpResponse("c")});
+
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Http);
+  cbuilder.endpoint(slow.endpoint());
+  auto connection = cbuilder.connect(loop);
+
+  f::WaitGroup wg;
+  wg.add(2);
+  f::Error errorA = f::Error::NoError, errorB = f::Error::NoError;
+  connection->sendRequest(f::createRequest(f::RestVerb::Get, "/a"),
+                          [&](f::Error e, std::unique_ptr<f::Request>,
+                              std::unique_ptr<f::Response>) {
+                            errorA = e;
+                            wg.done();
+                          });
+  f::MessageID queued = connection->sendRequest(
+      f::createRequest(f::RestVerb::Get, "/b"),
+      [&](f::Error e, std::unique_ptr<f::Request>,
+          std::unique_ptr<f::Response>) {
+        errorB = e;
+        wg.done();
+      });
+  connection->cancelRequest(queued);
+
+  // a later request finishes first, on another connection
+  cbuilder.endpoint(fast.endpoint());
+  auto other = cbuilder.connect(loop);
+  f::WaitGroup finished;
+  finished.add();
+  f::MessageID done = other->sendRequest(
+      f::createRequest(f::RestVerb::Get, "/c"),
+      [&](f::Error, std::unique_ptr<f::Request>,
+          std::unique_ptr<f::Response>) { finished.done(); });
+  bool otherDone = finished.wait_for(std::chrono::seconds(5));
+  connection->cancelRequest(done);
+
+  release.set_value();
+  bool allDone = wg.wait_for(std::chrono::seconds(5));
+  connection->cancel();
+  other->cancel();
+
+  ASSERT_TRUE(otherDone);
+  ASSERT_GT(done, queued);
+  ASSERT_TRUE(allDone);
+  ASSERT_EQ(errorA, f::Error::NoError);
+  ASSERT_EQ(errorB, f::Error::Canceled);
+}
+
+// a large message canceled while it is written a few chunks at a time is
+// still written completely, the server never sees a truncated message
+TEST(CancelTest, VstPartiallyWritten) {
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  ScriptedServer server(f::ProtocolType::Vst,
+                        {[released](uint64_t mid) {
+                           released.wait();  // stalls the write of /a
+                           return vstResponse(f::vst::VST1_1, "a")(mid);
+                         },
+                         vstResponse(f::vst::VST1_1, "b")});
+
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint(server.endpoint());
+  auto connection = cbuilder.connect(loop);
+
+  auto request = f::createRequest(f::RestVerb::Post, "/a");
+  std::vector<uint8_t> body(16 * 1024 * 1024, 'r');  // many chunks
+  request->addBinary(body.data(), body.size());
+  f::WaitGroup wg;
+  wg.add();
+  f::Error errorA = f::Error::NoError;
+  f::MessageID mid = connection->sendRequest(
+      std::move(request), [&](f::Error e, std::unique_ptr<f::Request>,
+                              std::unique_ptr<f::Response>) {
+        errorA = e;
+        wg.done();
+      });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  connection->cancelRequest(mid);  // the first slices are on the wire
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  release.set_value();
+  bool canceled = wg.wait_for(std::chrono::seconds(5));
+
+  f::RequestResult result = connection->sendRequest(
+      f::createRequest(f::RestVerb::Get, "/b"), std::nothrow);
+  connection->cancel();
+
+  ASSERT_TRUE(canceled);
+  ASSERT_EQ(errorA, f::Error::Canceled);
+  ASSERT_EQ(result.error, f::Error::NoError);
+  ASSERT_EQ(result.response->payloadAsString(), "b");
+  ASSERT_EQ(server.incompleteMessages(), 0);
+}
@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include "CircuitBreaker.h"
+#include <fuerte/loop.h>
+#include <thread>
+
+namespace f = ::arangodb::fuerte;
+
+// the circuit breaker opens after enough failures and lets a single
+// probe through once the open timeout has elapsed
+TEST(CircuitBreakerTest, OpenHalfOpenClose) {
+  f::detail::ConnectionConfiguration conf;
+  conf._breakerFailureRatio = 0.5;
+  conf._breakerMinRequests = 4;
+  conf._breakerOpenTimeout = std::chrono::milliseconds(50);
+  f::CircuitBreaker breaker(conf);
+
+  bool probe = false;
+  breaker.reportSuccess(false);
+  breaker.reportSuccess(false);
+  breaker.reportFailure(false);
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::Closed);
+  breaker.reportFailure(false);
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::Open);
+  ASSERT_FALSE(breaker.allowRequest(probe));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  ASSERT_TRUE(breaker.allowRequest(probe));
+  ASSERT_TRUE(probe);
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::HalfOpen);
+  ASSERT_FALSE(breaker.allowRequest(probe));
+
+  breaker.reportFailure(true);  // probe failed
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::Open);
+  ASSERT_FALSE(breaker.allowRequest(probe));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  ASSERT_TRUE(breaker.allowRequest(probe));
+  ASSERT_TRUE(probe);
+  breaker.reportSuccess(true);  // probe succeeded
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::Closed);
+  ASSERT_TRUE(breaker.allowRequest(probe));
+  ASSERT_FALSE(probe);
+}
+
+// late successes of requests sent before the breaker opened do not close
+// it, only the probe does
+TEST(CircuitBreakerTest, OnlyTheProbeCloses) {
+  f::detail::ConnectionConfiguration conf;
+  conf._breakerFailureRatio = 0.5;
+  conf._breakerMinRequests = 2;
+  conf._breakerOpenTimeout = std::chrono::milliseconds(50);
+  f::CircuitBreaker breaker(conf);
+
+  bool probe = false;
+  breaker.reportFailure(false);
+  breaker.reportFailure(false);
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::Open);
+  breaker.reportSuccess(false);  // straggler while open
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::Open);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  ASSERT_TRUE(breaker.allowRequest(probe));
+  ASSERT_TRUE(probe);
+  breaker.reportSuccess(false);  // straggler while half-open
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::HalfOpen);
+  breaker.reportSuccess(true);
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::Closed);
+}
+
+// late failures of requests sent before the breaker opened neither re-open
+// it nor delay the probe, only a failed probe does
+TEST(CircuitBreakerTest, OnlyTheProbeReopens) {
+  f::detail::ConnectionConfiguration conf;
+  conf._breakerFailureRatio = 0.5;
+  conf._breakerMinRequests = 2;
+  conf._breakerOpenTimeout = std::chrono::milliseconds(50);
+  f::CircuitBreaker breaker(conf);
+
+  bool probe = false;
+  breaker.reportFailure(false);
+  breaker.reportFailure(false);
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::Open);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  breaker.reportFailure(false);  // straggler while open
+  ASSERT_TRUE(breaker.allowRequest(probe));
+  ASSERT_TRUE(probe);
+  breaker.reportFailure(false);  // straggler while half-open
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::HalfOpen);
+  breaker.reportFailure(true);
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::Open);
+}
+
+// a probe that was granted but never sent (the queue was full) is given
+// back, the next request probes without waiting for another open timeout
+TEST(CircuitBreakerTest, ReleaseUnsentProbe) {
+  f::detail::ConnectionConfiguration conf;
+  conf._breakerFailureRatio = 0.5;
+  conf._breakerMinRequests = 2;
+  conf._breakerOpenTimeout = std::chrono::milliseconds(50);
+  f::CircuitBreaker breaker(conf);
+
+  bool probe = false;
+  breaker.reportFailure(false);
+  breaker.reportFailure(false);
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  ASSERT_TRUE(breaker.allowRequest(probe));
+  ASSERT_TRUE(probe);
+  ASSERT_FALSE(breaker.allowRequest(probe));
+
+  breaker.releaseProbe();
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::HalfOpen);
+  ASSERT_TRUE(breaker.allowRequest(probe));
+  ASSERT_TRUE(probe);
+  breaker.reportSuccess(true);
+  ASSERT_EQ(breaker.state(), f::CircuitBreaker::State::Closed);
+}
+
+// connections to the same endpoint only share a breaker if they use the
+// same settings
+TEST(CircuitBreakerTest, SharedPerSettings) {
+  f::EventLoopService loop;
+  f::detail::ConnectionConfiguration strict;
+  strict._breakerFailureRatio = 0.1;
+  f::detail::ConnectionConfiguration lenient;
+  lenient._breakerFailureRatio = 0.9;
+
+  auto a = loop.circuitBreaker("tcp://localhost:8529", strict);
+  ASSERT_EQ(loop.circuitBreaker("tcp://localhost:8529", strict), a);
+  ASSERT_NE(loop.circuitBreaker("tcp://localhost:8529", lenient), a);
+  ASSERT_NE(loop.circuitBreaker("tcp://localhost:8530", strict), a);
+}
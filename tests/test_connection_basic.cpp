@@ -183,6 +183,64 @@ TEST_P(ConnectionTestF, ShortAndLongASync){
   wg.wait();
 }
 
+TEST_P(ConnectionTestF, CancelRequest){
+  auto sleepRequest = [] {
+    auto request = fu::createRequest(fu::RestVerb::Post, "/_api/cursor");
+    VPackBuilder builder;
+    builder.openObject();
+    builder.add("query", VPackValue("RETURN SLEEP(2)"));
+    builder.close();
+    request->addVPack(builder.slice());
+    return request;
+  };
+
+  fu::WaitGroup wg;
+  std::atomic<int> canceled(0);
+  fu::RequestCallback cb = [&](fu::Error error, std::unique_ptr<fu::Request>,
+                               std::unique_ptr<fu::Response>) {
+    fu::WaitGroupDone done(wg);
+    ASSERT_EQ(error, fu::Error::Canceled);
+    canceled++;
+  };
+
+  // one request in flight, one still queued on HTTP
+  wg.add(2);
+  fu::MessageID first = _connection->sendRequest(sleepRequest(), cb);
+  fu::MessageID second = _connection->sendRequest(sleepRequest(), cb);
+  _connection->cancelRequest(second);
+  _connection->cancelRequest(first);
+  ASSERT_TRUE(wg.wait_for(std::chrono::seconds(1)));
+  ASSERT_EQ(canceled, 2);
+
+  // the connection is still usable
+  auto request = fu::createRequest(fu::RestVerb::Get, "/_api/version");
+  auto response = _connection->sendRequest(std::move(request));
+  ASSERT_EQ(response->statusCode(), fu::StatusOK);
+}
+
+TEST_P(ConnectionTestF, FutureWhenAll) {
+  std::vector<fu::Future<fu::RequestResult>> futures;
+  for (int i = 0; i < 16; i++) {
+    auto request = fu::createRequest(fu::RestVerb::Get, "/_api/version");
+    futures.push_back(fu::sendRequest(*_connection, std::move(request),
+                                      fu::useFuture));
+  }
+  fu::WaitGroup wg;
+  wg.add();
+  size_t ok = 0;
+  fu::whenAll(std::move(futures))
+      .then([&](std::vector<fu::RequestResult>&& results) {
+        fu::WaitGroupDone done(wg);
+        for (auto const& res : results) {
+          if (res.ok() && res.response->statusCode() == fu::StatusOK) {
+            ok++;
+          }
+        }
+      });
+  ASSERT_TRUE(wg.wait_for(std::chrono::seconds(10)));
+  ASSERT_EQ(ok, 16u);
+}
+
 // threads parameter has no effect in this testsuite
 static const ConnectionTestParams connectionTestBasicParams[] = {
   {._url= "http://127.0.0.1:8529", ._threads=1, ._repeat=100},
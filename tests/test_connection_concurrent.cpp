@@ -49,6 +49,18 @@ class ConcurrentConnectionF : public ConnectionTestF {
     ASSERT_EQ(dropCollection("concurrent"), fu::StatusOK);
     ConnectionTestF::TearDown();
   }
+
+ protected:
+  // wait for queue space instead of overrunning the request queue
+  void sendWithBackpressure(std::unique_ptr<fu::Request> request,
+                            fu::RequestCallback cb) {
+    while (_connection->trySendRequest(request, cb) == 0) {
+      fu::WaitGroup space;
+      space.add();
+      _connection->notifyOnQueueSpace([&space] { space.done(); });
+      space.wait();
+    }
+  }
 };
 
 TEST_P(ConcurrentConnectionF, ApiVersionParallel) {
@@ -75,10 +87,7 @@ TEST_P(ConcurrentConnectionF, ApiVersionParallel) {
     joins.emplace_back([&]{
       for (size_t i = 0; i < repeat(); i++) {
         auto request = fu::createRequest(fu::RestVerb::Get, "/_api/version");
-        while (_connection->requestsLeft() >= 1000) {
-          std::this_thread::yield();
-        }
-        _connection->sendRequest(std::move(request), cb);
+        sendWithBackpressure(std::move(request), cb);
       }
     });
   }
@@ -123,10 +132,7 @@ TEST_P(ConcurrentConnectionF, CreateDocumentsParallel){
       for (size_t i = 0; i < repeat(); i++) {
         auto request = fu::createRequest(fu::RestVerb::Post, "/_api/document/concurrent");
         request->addVPack(builder.slice());
-        while (_connection->requestsLeft() >= 1000) {
-          std::this_thread::yield();
-        }
-        _connection->sendRequest(std::move(request), cb);
+        sendWithBackpressure(std::move(request), cb);
       }
     });
   }
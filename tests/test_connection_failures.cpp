@@ -74,3 +74,119 @@ TEST(ConnectionFailureTest, CannotConnectVst) {
   tryToConnectExpectFailure(loop, "vst://localhost:8629");
 }
 
+
+// prewarming reports every connection, even if none can be established
+TEST(ConnectionFailureTest, PrewarmCannotConnect) {
+  f::EventLoopService loop;
+  f::WaitGroup wg;
+  wg.add();
+  std::size_t connected = 42;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint("vst://localhost:8629");
+  auto connections = cbuilder.prewarm(loop, 4, [&](std::size_t n) {
+    connected = n;
+    wg.done();
+  });
+  ASSERT_EQ(connections.size(), 4);
+  ASSERT_TRUE(wg.wait_for(std::chrono::seconds(5)));
+  ASSERT_EQ(connected, 0);
+}
+
+// requests on a dead endpoint fail fast once the breaker is open
+TEST(ConnectionFailureTest, CircuitBreakerFastFail) {
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint("http://localhost:8629");
+  cbuilder.breakerFailureRatio(0.5).breakerMinRequests(2);
+
+  for (int i = 0; i < 2; i++) {
+    f::WaitGroup wg;
+    wg.add();
+    auto connection = cbuilder.connect(loop);
+    auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+    connection->sendRequest(std::move(request),
+                            [&](f::Error e, std::unique_ptr<f::Request>,
+                                std::unique_ptr<f::Response>) {
+      f::WaitGroupDone done(wg);
+      ASSERT_NE(e, f::Error::NoError);
+    });
+    ASSERT_TRUE(wg.wait_for(std::chrono::seconds(5)));
+  }
+
+  auto connection = cbuilder.connect(loop);
+  f::Error error = f::Error::NoError;
+  auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+  connection->sendRequest(std::move(request),
+                          [&](f::Error e, std::unique_ptr<f::Request>,
+                              std::unique_ptr<f::Response>) { error = e; });
+  ASSERT_EQ(error, f::Error::CircuitOpen);  // callback ran synchronously
+}
+
+// producers wait for queue space instead of overrunning a bounded queue
+TEST(ConnectionFailureTest, QueueBackpressure) {
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint("http://localhost:8629");
+  cbuilder.maxQueuedRequests(1);
+  auto connection = cbuilder.connect(loop);
+
+  f::WaitGroup wg;
+  f::RequestCallback cb = [&](f::Error e, std::unique_ptr<f::Request>,
+                              std::unique_ptr<f::Response>) {
+    f::WaitGroupDone done(wg);
+    ASSERT_NE(e, f::Error::QueueCapacityExceeded);
+  };
+
+  for (int i = 0; i < 4; i++) {
+    wg.add();
+    auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+    f::RequestCallback callback = cb;
+    while (connection->trySendRequest(request, callback) == 0) {
+      ASSERT_NE(request, nullptr);  // still owned by us
+      f::WaitGroup space;
+      space.add();
+      connection->notifyOnQueueSpace([&space] { space.done(); });
+      ASSERT_TRUE(space.wait_for(std::chrono::seconds(5)));
+    }
+  }
+  ASSERT_TRUE(wg.wait_for(std::chrono::seconds(5)));
+}
+
+// callbacks run on the executor, not on the IO thread
+TEST(ConnectionFailureTest, CallbackExecutor) {
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint("http://localhost:8629");
+  cbuilder.callbackExecutor(std::make_shared<f::WorkStealingPool>(1));
+  auto connection = cbuilder.connect(loop);
+
+  f::WaitGroup wg;
+  wg.add();
+  int ioContext = 0;
+  auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+  connection->sendRequest(std::move(request),
+                          [&](f::Error e, std::unique_ptr<f::Request> req,
+                              std::unique_ptr<f::Response>) {
+                            f::WaitGroupDone done(wg);
+                            ASSERT_NE(req, nullptr);
+                            ioContext = loop.currentIOContext();
+                          });
+  ASSERT_TRUE(wg.wait_for(std::chrono::seconds(5)));
+  ASSERT_EQ(ioContext, -1);
+}
+
+// the synchronous API reports errors as a result instead of throwing
+TEST(ConnectionFailureTest, SyncResultNoThrow) {
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint("http://localhost:8629");
+  auto connection = cbuilder.connect(loop);
+
+  auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+  f::RequestResult result = connection->sendRequest(std::move(request),
+                                                    std::nothrow);
+  ASSERT_FALSE(result.ok());
+  ASSERT_EQ(result.error, f::Error::CouldNotConnect);
+  ASSERT_NE(result.request, nullptr);
+  ASSERT_EQ(result.response, nullptr);
+}
@@ -86,3 +86,43 @@ TEST(Timeouts, VelocyStream){
 TEST(RequestTimeout, HTTP) {
   performRequests("http://127.0.0.1:8529");
 }
+
+// requests past their deadline are failed before they are written
+static void expiredDeadline(std::string const& host) {
+  fu::EventLoopService loop;
+  fu::ConnectionBuilder cbuilder;
+  cbuilder.endpoint(host);
+  cbuilder.deadlineHeader("x-arango-queue-time-seconds");
+  setupAuthenticationFromEnv(cbuilder);
+  auto connection = cbuilder.connect(loop);
+
+  fu::WaitGroup wg;
+  wg.add(2);
+  auto expired = fu::createRequest(fu::RestVerb::Get, "/_api/version");
+  expired->deadline(std::chrono::steady_clock::now());
+  connection->sendRequest(std::move(expired),
+                          [&](fu::Error e, std::unique_ptr<fu::Request>,
+                              std::unique_ptr<fu::Response>) {
+    fu::WaitGroupDone done(wg);
+    ASSERT_EQ(e, fu::Error::Timeout);
+  });
+
+  auto req = fu::createRequest(fu::RestVerb::Get, "/_api/version");
+  req->deadline(std::chrono::steady_clock::now() + std::chrono::seconds(10));
+  connection->sendRequest(std::move(req),
+                          [&](fu::Error e, std::unique_ptr<fu::Request>,
+                              std::unique_ptr<fu::Response> res) {
+    fu::WaitGroupDone done(wg);
+    ASSERT_EQ(e, fu::Error::NoError);
+    ASSERT_EQ(res->statusCode(), fu::StatusOK);
+  });
+  ASSERT_TRUE(wg.wait_for(std::chrono::seconds(3)));
+}
+
+TEST(Deadline, VelocyStream) {
+  expiredDeadline("vst://127.0.0.1:8529");
+}
+
+TEST(Deadline, HTTP) {
+  expiredDeadline("http://127.0.0.1:8529");
+}
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include <fuerte/coro.h>
+#include <fuerte/fuerte.h>
+#include <fuerte/helper.h>
+#include <fuerte/loop.h>
+#include <atomic>
+
+// built as C++20 by tests/CMakeLists.txt, the library itself is C++17
+static_assert(FUERTE_HAS_COROUTINES, "test_coro must be built as C++20");
+
+namespace f = ::arangodb::fuerte;
+
+namespace {
+// fire and forget coroutine
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+Detached fetchVersion(f::EventLoopService& loop, f::Connection& conn,
+                      f::CallbackExecutor* executor, f::WaitGroup& wg,
+                      std::atomic<int>& failed, std::atomic<int>& onIO) {
+  f::WaitGroupDone done(wg);
+  auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+  f::RequestResult res =
+      co_await f::request(conn, std::move(request), executor);
+  if (res.error == f::Error::CouldNotConnect && res.request != nullptr) {
+    failed++;
+  }
+  if (loop.currentIOContext() != -1) {
+    onIO++;
+  }
+}
+}  // namespace
+
+// every coroutine is resumed exactly once with its result, on the IO
+// thread or on the executor
+TEST(CoroutineTest, FanOut) {
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint("http://localhost:8629");
+  auto executor = std::make_shared<f::WorkStealingPool>(2);
+
+  for (f::CallbackExecutor* e : {static_cast<f::CallbackExecutor*>(nullptr),
+                                 static_cast<f::CallbackExecutor*>(
+                                     executor.get())}) {
+    auto connection = cbuilder.connect(loop);
+    f::WaitGroup wg;
+    std::atomic<int> failed(0);
+    std::atomic<int> onIO(0);
+    wg.add(32);
+    for (int i = 0; i < 32; i++) {
+      fetchVersion(loop, *connection, e, wg, failed, onIO);
+    }
+    ASSERT_TRUE(wg.wait_for(std::chrono::seconds(10)));
+    ASSERT_EQ(failed, 32);
+    ASSERT_EQ(onIO, e == nullptr ? 32 : 0);
+  }
+}
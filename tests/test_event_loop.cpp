@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include <fuerte/loop.h>
+#include <fuerte/types.h>
+#include <fuerte/waitgroup.h>
+#include <string>
+#include <thread>
+
+namespace f = ::arangodb::fuerte;
+
+// connections go to the least loaded io_context unless placed explicitly
+TEST(EventLoopServiceTest, LoadAwareAssignment) {
+  f::EventLoopService loop(2);
+  size_t a = loop.acquireIOContext();
+  size_t b = loop.acquireIOContext();
+  ASSERT_NE(a, b);
+
+  loop.addQueued(a, 5);  // a is busy now
+  ASSERT_EQ(loop.acquireIOContext(), b);
+  ASSERT_EQ(loop.acquireIOContext(), b);
+  ASSERT_EQ(loop.acquireIOContext(static_cast<int>(a)), a);
+  ASSERT_EQ(loop.load(a), 7u);
+  ASSERT_EQ(loop.load(b), 3u);
+  loop.addQueued(a, -5);
+
+  ASSERT_EQ(loop.currentIOContext(), -1);
+  f::WaitGroup wg;
+  wg.add();
+  int current = -1;
+  asio_ns::post(*loop.ioContext(b), [&] {
+    current = loop.currentIOContext();
+    wg.done();
+  });
+  ASSERT_TRUE(wg.wait_for(std::chrono::seconds(5)));
+  ASSERT_EQ(current, static_cast<int>(b));
+}
+
+// busy polling threads run handlers and still shut down cleanly
+TEST(EventLoopServiceTest, BusyPoll) {
+  f::LoopOptions options;
+  options.threadCount = 2;
+  options.busyPollThreads = 1;
+  options.spinBudget = std::chrono::microseconds(100);
+  f::EventLoopService loop(options);
+
+  for (size_t i = 0; i < loop.numIOContexts(); i++) {
+    f::WaitGroup wg;
+    wg.add();
+    asio_ns::post(*loop.ioContext(i), [&] { wg.done(); });
+    ASSERT_TRUE(wg.wait_for(std::chrono::seconds(5)));
+    // after the spin budget the thread blocks, it must still wake up
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    wg.add();
+    asio_ns::post(*loop.ioContext(i), [&] { wg.done(); });
+    ASSERT_TRUE(wg.wait_for(std::chrono::seconds(5)));
+  }
+}
+
+// connections of a loop share its budget for buffered responses
+TEST(EventLoopServiceTest, MemoryBudget) {
+  f::LoopOptions options;
+  options.memoryBudget = 1000;
+  f::EventLoopService loop(options);
+
+  ASSERT_TRUE(loop.chargeMemory(600));
+  ASSERT_FALSE(loop.chargeMemory(500));  // would exceed, nothing charged
+  ASSERT_EQ(loop.bufferedBytes(), 600);
+  ASSERT_TRUE(loop.chargeMemory(400));
+  loop.releaseMemory(1000);
+  ASSERT_EQ(loop.bufferedBytes(), 0);
+
+  f::EventLoopService unlimited;
+  ASSERT_TRUE(unlimited.chargeMemory(std::size_t(1) << 40));
+  unlimited.releaseMemory(std::size_t(1) << 40);
+
+  ASSERT_NE(f::to_string(f::Error::ResponseTooLarge),
+            f::to_string(f::Error::MemoryBudgetExceeded));
+}
+
+// the reactor is fixed at build time, epoll unless built with io_uring
+TEST(EventLoopServiceTest, Backend) {
+  std::string backend = f::EventLoopService::backend();
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT) || \
+    defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+  ASSERT_EQ(backend, "io_uring");
+#elif defined(__linux__)
+  ASSERT_EQ(backend, "epoll");
+#else
+  ASSERT_FALSE(backend.empty());
+#endif
+}
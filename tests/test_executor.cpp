@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include <fuerte/executor.h>
+#include <fuerte/fuerte.h>
+#include <fuerte/loop.h>
+#include <atomic>
+#include <thread>
+
+namespace f = ::arangodb::fuerte;
+
+// every posted task runs, including tasks posted by tasks
+TEST(WorkStealingPoolTest, RunsAllTasks) {
+  constexpr int numTasks = 1000;
+  std::atomic<int> done(0);
+  {
+    f::WorkStealingPool pool(4);
+    for (int i = 0; i < numTasks; i++) {
+      pool.post([&] {
+        pool.post([&] { done.fetch_add(1); });
+        done.fetch_add(1);
+      });
+    }
+  }  // pending tasks still run on destruction
+  ASSERT_EQ(done.load(), 2 * numTasks);
+}
+
+// a request refused because the queue is full completes on the executor
+// too, not on the thread calling sendRequest
+TEST(WorkStealingPoolTest, QueueFullRunsOnExecutor) {
+  struct CountingExecutor : public f::CallbackExecutor {
+    f::WorkStealingPool pool{1};
+    std::atomic<int> posted{0};
+    void post(std::function<void()> task) override {
+      posted.fetch_add(1);
+      pool.post(std::move(task));
+    }
+  };
+  auto executor = std::make_shared<CountingExecutor>();
+
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint("http://127.0.0.1:8529");
+  cbuilder.maxQueuedRequests(0);  // refuses everything, never connects
+  cbuilder.callbackExecutor(executor);
+  auto connection = cbuilder.connect(loop);
+
+  f::WaitGroup wg;
+  wg.add();
+  f::Error error = f::Error::NoError;
+  std::thread::id thread;
+  connection->sendRequest(f::createRequest(f::RestVerb::Get, "/"),
+                          [&](f::Error e, std::unique_ptr<f::Request>,
+                              std::unique_ptr<f::Response>) {
+                            f::WaitGroupDone done(wg);
+                            error = e;
+                            thread = std::this_thread::get_id();
+                          });
+  ASSERT_TRUE(wg.wait_for(std::chrono::seconds(5)));
+  connection->cancel();
+
+  ASSERT_EQ(error, f::Error::QueueCapacityExceeded);
+  ASSERT_NE(thread, std::this_thread::get_id());
+  ASSERT_EQ(executor->posted.load(), 1);
+}
@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include <fuerte/future.h>
+#include <thread>
+#include <vector>
+
+namespace f = ::arangodb::fuerte;
+
+// continuations run no matter whether the value or the callback is first
+TEST(FutureTest, ThenWhenAllWhenAny) {
+  f::Promise<int> early;
+  early.setValue(1);
+  int seen = 0;
+  early.getFuture().then([&](int v) { seen = v; });
+  ASSERT_EQ(seen, 1);
+
+  std::vector<f::Promise<int>> promises(3);
+  std::vector<f::Future<int>> all, any;
+  for (auto& p : promises) {
+    all.push_back(p.getFuture().then([](int v) { return v * 2; }));
+  }
+  f::Promise<int> a, b;
+  any.push_back(a.getFuture());
+  any.push_back(b.getFuture());
+
+  std::vector<int> values;
+  whenAll(std::move(all)).then([&](std::vector<int>&& v) { values = v; });
+  std::pair<size_t, int> first(0, 0);
+  whenAny(std::move(any)).then(
+      [&](std::pair<size_t, int>&& p) { first = p; });
+
+  std::thread t([&] {
+    promises[2].setValue(3);
+    promises[0].setValue(1);
+    b.setValue(7);
+  });
+  t.join();
+  ASSERT_TRUE(values.empty());
+  promises[1].setValue(2);
+  a.setValue(5);
+  ASSERT_EQ(values, (std::vector<int>{2, 4, 6}));
+  ASSERT_EQ(first.first, 1u);
+  ASSERT_EQ(first.second, 7);
+}
+
+// a request callback that is dropped without being invoked still
+// completes its future
+TEST(FutureTest, DroppedRequestCallbackCancels) {
+  f::detail::RequestPromise promise;
+  f::Future<f::RequestResult> future = promise.getFuture();
+  {
+    f::RequestHandler cb([promise = std::move(promise)](
+                             f::Error, std::unique_ptr<f::Request>,
+                             std::unique_ptr<f::Response>) mutable {});
+    ASSERT_FALSE(future.isReady());
+  }
+  ASSERT_TRUE(future.isReady());
+  f::Error error = f::Error::NoError;
+  future.then([&](f::RequestResult&& r) { error = r.error; });
+  ASSERT_EQ(error, f::Error::Canceled);
+}
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include <fuerte/HeaderMap.h>
+#include <fuerte/message.h>
+#include <string>
+#include <vector>
+
+namespace f = ::arangodb::fuerte;
+
+// well-known names are interned, entries are sorted by key
+TEST(HeaderMapTest, InternedAndCustomKeys) {
+  ASSERT_EQ(f::toHeaderId("etag"), f::HeaderId::Etag);
+  ASSERT_EQ(f::toHeaderId("x-arango-queue-time-seconds"),
+            f::HeaderId::XArangoQueueTimeSeconds);
+  ASSERT_EQ(f::toHeaderId("x-foo"), f::HeaderId::Custom);
+
+  f::HeaderMap map;
+  for (int i = 0; i < 6; i++) {  // spills over the inline entries
+    ASSERT_TRUE(map.emplace("x-key-" + std::to_string(i), std::to_string(i)));
+  }
+  ASSERT_TRUE(map.emplace(std::string("location"), "/_api/document/1"));
+  ASSERT_FALSE(map.emplace("x-key-2", "duplicate"));
+  ASSERT_EQ(map.size(), 7);
+
+  auto const* e = map.find("location");
+  ASSERT_NE(e, nullptr);
+  ASSERT_EQ(e->id, f::HeaderId::Location);
+  ASSERT_TRUE(e->name.empty());
+  ASSERT_EQ(e->key(), "location");
+  ASSERT_EQ(map.find(f::HeaderId::Location), e);
+  ASSERT_EQ(map.find("x-key-2")->value, "2");
+  ASSERT_EQ(map.find("etag"), nullptr);
+
+  map.set("x-key-2", "two");
+  ASSERT_EQ(map.find("x-key-2")->value, "two");
+  ASSERT_TRUE(map.erase("x-key-0"));
+  ASSERT_FALSE(map.erase("x-key-0"));
+  std::vector<std::string> keys;
+  for (auto const& entry : map) {
+    keys.emplace_back(entry.key());
+  }
+  ASSERT_EQ(keys, (std::vector<std::string>{"location", "x-key-1", "x-key-2",
+                                            "x-key-3", "x-key-4",
+                                            "x-key-5"}));
+
+  f::ResponseHeader header;
+  header.addMeta(std::string("content-type"), std::string("application/json"));
+  header.addMeta(std::string("etag"), std::string("\"abc\""));
+  ASSERT_EQ(header.contentType(), f::ContentType::Json);
+  ASSERT_EQ(header.metaByKey("etag"), "\"abc\"");
+  ASSERT_EQ(header.meta().size(), 1);
+}
+
+// query parameters come out sorted whatever order they were added in, as
+// with the std::map they used to live in
+TEST(HeaderMapTest, SortedParameters) {
+  f::RequestHeader header;
+  header.addParameter("waitForSync", "true");
+  header.addParameter("returnNew", "false");
+  header.addParameter("silent", "true");
+  header.addParameter("overwrite", "true");
+  header.addParameter("keepNull", "false");
+  header.addParameter("mergeObjects", "true");
+  std::vector<std::string> keys;
+  for (auto const& entry : header.parameters) {
+    keys.emplace_back(entry.key());
+  }
+  ASSERT_EQ(keys, (std::vector<std::string>{"keepNull", "mergeObjects",
+                                            "overwrite", "returnNew",
+                                            "silent", "waitForSync"}));
+  ASSERT_EQ(header.parameters.find("silent")->value, "true");
+}
@@ -0,0 +1,202 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include "AllocatedPayload.h"
+#include <fuerte/message.h>
+#include <velocypack/velocypack-aliases.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace f = ::arangodb::fuerte;
+
+// shared payload views point into the received buffer
+TEST(ResponseTest, SharePayloadWithoutCopy) {
+  std::string const prefix = "header";
+  // too large for the inline storage of a velocypack buffer
+  std::string const body = std::string(1000, 'p') + "payload bytes";
+  auto makeResponse = [&] {
+    auto res = std::make_unique<f::Response>();
+    VPackBuffer<uint8_t> buffer;
+    buffer.append(reinterpret_cast<uint8_t const*>(prefix.data()),
+                  prefix.size());
+    buffer.append(reinterpret_cast<uint8_t const*>(body.data()), body.size());
+    res->setPayload(std::move(buffer), prefix.size());
+    return res;
+  };
+
+  auto res = makeResponse();
+  f::PayloadSlice view = res->sharePayload();
+  ASSERT_EQ(view.size(), body.size());
+  ASSERT_EQ(static_cast<void const*>(view.data()), res->payload().data());
+  ASSERT_EQ(res->payloadAsString(), body);
+
+  f::PayloadSlice part = view.subslice(body.size() - 5, 100);
+  ASSERT_EQ(std::string(reinterpret_cast<char const*>(part.data()),
+                        part.size()),
+            "bytes");
+  std::shared_ptr<uint8_t const> bytes = part.share();
+  ASSERT_EQ(bytes.get(), part.data());
+
+  // views are alive, stealing copies and leaves them untouched
+  auto stolen = res->stealPayload();
+  ASSERT_EQ(stolen->byteSize(), body.size());
+  ASSERT_EQ(res->payloadSize(), 0);
+  res.reset();
+  ASSERT_EQ(std::string(reinterpret_cast<char const*>(view.data()),
+                        view.size()),
+            body);
+
+  // without views the prefix is dropped in place
+  res = makeResponse();
+  uint8_t const* received = static_cast<uint8_t const*>(res->payload().data());
+  stolen = res->stealPayload();
+  ASSERT_EQ(stolen->data(), received - prefix.size());
+  ASSERT_EQ(std::string(reinterpret_cast<char const*>(stolen->data()),
+                        stolen->byteSize()),
+            body);
+}
+
+// shared segments are referenced by the request, not copied into it
+TEST(RequestTest, PayloadSegments) {
+  std::string const head = "head-";
+  std::string const big = std::string(1000, 's');
+  auto shared = std::make_shared<VPackBuffer<uint8_t>>();
+  shared->append(reinterpret_cast<uint8_t const*>(big.data()), big.size());
+
+  f::Request req;
+  req.addBinary(reinterpret_cast<uint8_t const*>(head.data()), head.size());
+  req.addSegment(f::PayloadSlice(shared));
+  req.addSegment(f::PayloadSlice(shared).subslice(0, 3));
+  req.addBinary(reinterpret_cast<uint8_t const*>("-tail"), 5);
+  ASSERT_EQ(req.payloadSize(), head.size() + big.size() + 3 + 5);
+
+  std::vector<asio_ns::const_buffer> buffers;
+  req.payloadBuffers(buffers);
+  ASSERT_EQ(buffers.size(), 4);
+  ASSERT_EQ(buffers[1].data(), shared->data());
+  ASSERT_EQ(buffers[1].size(), big.size());
+
+  std::string const expected = head + big + "sss-tail";
+  asio_ns::const_buffer flat = req.payload();
+  ASSERT_EQ(std::string(static_cast<char const*>(flat.data()), flat.size()),
+            expected);
+
+  // copies share the segments
+  f::Request copy(req);
+  buffers.clear();
+  copy.payloadBuffers(buffers);
+  ASSERT_EQ(buffers[1].data(), shared->data());
+  flat = copy.payload();
+  ASSERT_EQ(std::string(static_cast<char const*>(flat.data()), flat.size()),
+            expected);
+}
+
+// const readers may flatten the segments concurrently
+TEST(RequestTest, PayloadSegmentsConcurrentReaders) {
+  auto shared = std::make_shared<VPackBuffer<uint8_t>>();
+  shared->append(reinterpret_cast<uint8_t const*>("abc"), 3);
+  f::Request req;
+  req.addBinary(reinterpret_cast<uint8_t const*>("x"), 1);
+  req.addSegment(f::PayloadSlice(shared));
+
+  std::vector<std::string> seen(4);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < seen.size(); i++) {
+    threads.emplace_back([&, i] {
+      f::Request const& r = req;
+      f::Request copy(r);
+      asio_ns::const_buffer flat = r.payload();
+      seen[i].assign(static_cast<char const*>(flat.data()), flat.size());
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  for (std::string const& s : seen) {
+    ASSERT_EQ(s, "xabc");
+  }
+}
+
+namespace {
+// hands out slices of one block, like an arena of a batch of requests
+struct TestArena final : public f::PayloadAllocator {
+  std::vector<uint8_t> block = std::vector<uint8_t>(4096);
+  std::size_t used = 0;
+  std::size_t live = 0;
+
+  uint8_t* allocate(std::size_t size) override {
+    if (used + size > block.size()) {
+      return nullptr;  // full, use the default heap
+    }
+    live++;
+    used += size;
+    return block.data() + used - size;
+  }
+  void deallocate(uint8_t*, std::size_t) noexcept override { live--; }
+};
+}  // namespace
+
+// response bodies can live in storage of a PayloadAllocator
+TEST(ResponseTest, AllocatedPayload) {
+  auto arena = std::make_shared<TestArena>();
+  std::string const body = "body in the arena";
+
+  f::AllocatedPayload payload;
+  ASSERT_TRUE(payload.allocate(arena, body.size()));
+  payload.append(body.data(), 4);
+  std::memcpy(payload.tail().data(), body.data() + 4, body.size() - 4);
+  payload.advance(body.size() - 4);
+
+  auto res = std::make_unique<f::Response>();
+  res->setPayload(payload.release());
+  ASSERT_FALSE(payload.active());
+  ASSERT_EQ(res->payload().data(), arena->block.data());
+  ASSERT_EQ(res->payloadAsString(), body);
+
+  // views keep the storage alive, stealing copies
+  f::PayloadSlice view = res->sharePayload();
+  auto stolen = res->stealPayload();
+  ASSERT_EQ(std::string(reinterpret_cast<char const*>(stolen->data()),
+                        stolen->byteSize()),
+            body);
+  ASSERT_EQ(res->payloadSize(), 0);
+  res.reset();
+  ASSERT_EQ(arena->live, 1);
+  view = f::PayloadSlice();
+  ASSERT_EQ(arena->live, 0);
+
+  // storage that is never handed out goes back right away
+  ASSERT_TRUE(payload.allocate(arena, 100));
+  payload.reset();
+  ASSERT_EQ(arena->live, 0);
+
+  // a declining allocator leaves the body where it is
+  ASSERT_TRUE(f::AllocatedPayload::copy(arena, arena->block.data(), 8192)
+                  .empty());
+  f::PayloadSlice copy = f::AllocatedPayload::copy(
+      arena, reinterpret_cast<uint8_t const*>(body.data()), body.size());
+  ASSERT_EQ(copy.size(), body.size());
+  ASSERT_EQ(arena->live, 1);
+}
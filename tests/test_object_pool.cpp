@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include "ObjectPools.h"
+#include <velocypack/velocypack-aliases.h>
+#include <chrono>
+#include <future>
+#include <string>
+
+namespace f = ::arangodb::fuerte;
+
+namespace {
+// checks from another thread that the pool is not locked while it is reset
+struct Probe {
+  f::ObjectPool<Probe>* pool = nullptr;
+  std::future<std::size_t> size;
+  bool locked = false;
+};
+
+void poolReset(Probe& probe) {
+  probe.size = std::async(std::launch::async,
+                          [pool = probe.pool] { return pool->size(); });
+  probe.locked = probe.size.wait_for(std::chrono::seconds(1)) !=
+                 std::future_status::ready;
+}
+}  // namespace
+
+// released objects are reset and handed out again, up to the capacity
+TEST(ObjectPoolTest, RecyclesResponses) {
+  f::ObjectPool<f::Response> pool(1);
+  f::Response* a = pool.acquire();
+  f::Response* b = pool.acquire();
+  ASSERT_NE(a, b);
+  a->header.responseCode = f::StatusOK;
+  a->header.addMeta(std::string("x-foo"), std::string("bar"));
+  pool.release(a);
+  pool.release(b);  // pool is full, deleted
+  ASSERT_EQ(pool.size(), 1);
+
+  f::Response* c = pool.acquire();
+  ASSERT_EQ(c, a);
+  ASSERT_EQ(c->header.responseCode, f::StatusUndefined);
+  ASSERT_TRUE(c->header.meta().empty());
+  ASSERT_EQ(pool.size(), 0);
+
+  { f::ObjectPool<f::Response>::Ptr p(c, {&pool}); }
+  ASSERT_EQ(pool.size(), 1);
+}
+
+// the payload buffer of a recycled response is handed back to the receive
+// path, steady state needs no new buffers
+TEST(ObjectPoolTest, KeepsPayloadCapacity) {
+  f::ObjectPool<f::Response> pool(1);
+  f::Response* res = pool.acquire();
+  VPackBuffer<uint8_t> received;
+  received.append(std::string(4096, 'x').data(), 4096);
+  uint8_t const* storage = received.data();
+  res->swapPayload(received, 0);
+  ASSERT_EQ(res->payloadSize(), 4096);
+  ASSERT_TRUE(received.empty());
+
+  pool.release(res);
+  res = pool.acquire();
+  ASSERT_EQ(res->payloadSize(), 0);
+  received.append(std::string(100, 'y').data(), 100);
+  res->swapPayload(received, 0);
+  ASSERT_EQ(received.data(), storage);  // the buffer of the first response
+  ASSERT_GE(received.capacity(), 4096);
+  delete res;
+}
+
+// objects are reset before the pool is locked, their destructors may take
+// as long as they like
+TEST(ObjectPoolTest, ResetsOutsideTheLock) {
+  f::ObjectPool<Probe> pool(1);
+  Probe* probe = pool.acquire();
+  probe->pool = &pool;
+  pool.release(probe);
+  ASSERT_EQ(pool.acquire(), probe);
+  probe->size.wait();
+  ASSERT_FALSE(probe->locked);
+  delete probe;
+}
@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include "OneShotEvent.h"
+#include <thread>
+
+namespace f = ::arangodb::fuerte;
+
+// set() before and after wait() both release the waiter
+TEST(OneShotEventTest, SetAndWait) {
+  f::OneShotEvent early;
+  early.set();
+  early.wait();
+
+  for (int i = 0; i < 100; i++) {
+    f::OneShotEvent event;
+    std::thread t([&event] { event.set(); });
+    event.wait();
+    t.join();
+  }
+}
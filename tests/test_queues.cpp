@@ -0,0 +1,182 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include "MPSCQueue.h"
+#include "PriorityQueue.h"
+#include <thread>
+#include <vector>
+
+namespace f = ::arangodb::fuerte;
+
+namespace {
+struct QueueItem : public f::MPSCQueueHook {
+  size_t producer;
+  size_t seq;
+};
+}  // namespace
+
+// items of each producer come out in order, none are lost
+TEST(MPSCQueueTest, MultiProducerOrder) {
+  constexpr size_t numProducers = 4;
+  constexpr size_t perProducer = 10000;
+  f::MPSCQueue<QueueItem> queue;
+  ASSERT_TRUE(queue.empty());
+  ASSERT_EQ(queue.pop(), nullptr);
+
+  std::vector<QueueItem> items(numProducers * perProducer);
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < numProducers; p++) {
+    producers.emplace_back([&, p] {
+      for (size_t i = 0; i < perProducer; i++) {
+        QueueItem& item = items[p * perProducer + i];
+        item.producer = p;
+        item.seq = i;
+        queue.push(&item);
+      }
+    });
+  }
+
+  std::vector<size_t> next(numProducers, 0);
+  size_t popped = 0;
+  while (popped < items.size()) {
+    popped += queue.drain([&](QueueItem* item) {
+      ASSERT_EQ(item->seq, next[item->producer]);
+      next[item->producer]++;
+    });
+  }
+  for (std::thread& t : producers) {
+    t.join();
+  }
+  ASSERT_TRUE(queue.empty());
+  ASSERT_EQ(queue.pop(), nullptr);
+}
+
+// drain takes everything pushed so far at once, also after pop() ran
+TEST(MPSCQueueTest, DrainTakesAll) {
+  f::MPSCQueue<QueueItem> queue;
+  std::vector<QueueItem> items(8);
+  for (size_t i = 0; i < items.size(); i++) {
+    items[i].seq = i;
+  }
+
+  std::vector<size_t> order;
+  auto collect = [&](QueueItem* item) { order.push_back(item->seq); };
+  ASSERT_EQ(queue.drain(collect), 0);
+  queue.push(&items[0]);
+  ASSERT_EQ(queue.drain(collect), 1);
+  ASSERT_TRUE(queue.empty());
+
+  for (size_t i = 1; i < 4; i++) {
+    queue.push(&items[i]);
+  }
+  ASSERT_EQ(queue.pop(), &items[1]);  // leaves the stub behind the last item
+  queue.push(&items[4]);
+  queue.push(&items[5]);
+  ASSERT_EQ(queue.drain(collect), 4);
+  ASSERT_TRUE(queue.empty());
+
+  queue.push(&items[6]);
+  ASSERT_EQ(queue.pop(), &items[6]);
+  queue.push(&items[7]);
+  ASSERT_EQ(queue.drain(collect), 1);
+  ASSERT_EQ(queue.pop(), nullptr);
+
+  std::vector<size_t> expected = {0, 2, 3, 4, 5, 7};
+  ASSERT_EQ(order, expected);
+}
+
+// find() looks at queued items without taking them
+TEST(MPSCQueueTest, Find) {
+  f::MPSCQueue<QueueItem> queue;
+  std::vector<QueueItem> items(4);
+  auto seqIs = [](size_t n) {
+    return [n](QueueItem const* item) { return item->seq == n; };
+  };
+  ASSERT_EQ(queue.find(seqIs(0)), nullptr);
+  for (size_t i = 0; i < items.size(); i++) {
+    items[i].seq = i;
+    queue.push(&items[i]);
+  }
+  ASSERT_EQ(queue.pop(), &items[0]);
+  ASSERT_EQ(queue.find(seqIs(0)), nullptr);
+  ASSERT_EQ(queue.find(seqIs(3)), &items[3]);
+  ASSERT_EQ(queue.find(seqIs(1)), &items[1]);
+  std::size_t drained = queue.drain([](QueueItem*) {});
+  ASSERT_EQ(drained, 3);
+  ASSERT_EQ(queue.find(seqIs(3)), nullptr);
+}
+
+// higher classes go first, but every class gets its share per round
+TEST(PriorityQueueTest, WeightedRoundRobin) {
+  using Queue = f::PriorityQueue<QueueItem>;
+  Queue queue(Queue::Weights{{2, 1, 1}});
+  std::vector<QueueItem> items(9);
+  for (size_t i = 0; i < items.size(); i++) {
+    items[i].producer = i % 3;  // used as priority class
+    items[i].seq = i;
+    queue.push(&items[i], static_cast<f::RequestPriority>(i % 3));
+  }
+
+  std::vector<size_t> order;
+  while (QueueItem* item = queue.pop()) {
+    order.push_back(item->producer);
+  }
+  std::vector<size_t> expected = {0, 0, 1, 2, 0, 1, 2, 1, 2};
+  ASSERT_EQ(order, expected);
+  ASSERT_TRUE(queue.empty());
+
+  queue.push(&items[2], f::RequestPriority::Low);
+  queue.push(&items[0], f::RequestPriority::High);
+  ASSERT_EQ(queue.popAbove(f::RequestPriority::High), nullptr);
+  ASSERT_EQ(queue.popAbove(f::RequestPriority::Low), &items[0]);
+  ASSERT_EQ(queue.pop(), &items[2]);
+}
+
+// a pop drains a whole class at once, later pushes queue up behind it
+TEST(PriorityQueueTest, BatchedPop) {
+  using Queue = f::PriorityQueue<QueueItem>;
+  Queue queue(Queue::Weights{{1, 1, 1}});
+  std::vector<QueueItem> items(5);
+  for (size_t i = 0; i < items.size(); i++) {
+    items[i].seq = i;
+  }
+  auto seqIs = [](size_t s) {
+    return [s](QueueItem const* item) { return item->seq == s; };
+  };
+  queue.push(&items[0], f::RequestPriority::Normal);
+  queue.push(&items[1], f::RequestPriority::Normal);
+  queue.push(&items[2], f::RequestPriority::Normal);
+  ASSERT_EQ(queue.pop(), &items[0]);  // items 1 and 2 are batched now
+  queue.push(&items[3], f::RequestPriority::Normal);
+  ASSERT_FALSE(queue.empty());
+  ASSERT_EQ(queue.find(seqIs(2)), &items[2]);
+  ASSERT_EQ(queue.find(seqIs(3)), &items[3]);
+  ASSERT_EQ(queue.pop(), &items[1]);
+
+  std::vector<size_t> drained;
+  queue.push(&items[4], f::RequestPriority::High);
+  queue.drain([&](QueueItem* item) { drained.push_back(item->seq); });
+  std::vector<size_t> expected = {4, 2, 3};
+  ASSERT_EQ(drained, expected);
+  ASSERT_TRUE(queue.empty());
+  ASSERT_EQ(queue.pop(), nullptr);
+}
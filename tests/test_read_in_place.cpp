@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+#include "scripted_server.h"
+
+#include <fuerte/fuerte.h>
+#include <fuerte/loop.h>
+#include <memory>
+#include <thread>
+
+namespace f = ::arangodb::fuerte;
+
+namespace {
+
+// large enough to be read in place after the first slice
+constexpr std::size_t bodySize = 256 * 1024;
+constexpr std::size_t sliceSize = 16 * 1024;
+
+// no byte repeats at a power of two distance, so misplaced slices show
+std::string patterned(std::size_t size) {
+  std::string body(size, '\0');
+  for (std::size_t i = 0; i < size; i++) {
+    body[i] = static_cast<char>(i % 251);
+  }
+  return body;
+}
+
+f::RequestResult get(f::Connection& connection) {
+  auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+  return connection.sendRequest(std::move(request), std::nothrow);
+}
+
+ScriptedServer::Response vstSingleChunkResponse(std::string const& body) {
+  return [body](uint64_t messageID) { return vstSingleChunk(messageID, body); };
+}
+
+// two large responses in a row arrive byte for byte
+void expectLargeBodies(f::ConnectionBuilder& cbuilder,
+                       ScriptedServer::Response first,
+                       ScriptedServer::Response second,
+                       std::string const& expected) {
+  ScriptedServer server(cbuilder.protocolType(),
+                        {std::move(first), std::move(second)}, sliceSize,
+                        std::chrono::milliseconds(2));
+  f::EventLoopService loop;
+  cbuilder.endpoint(server.endpoint());
+  auto connection = cbuilder.connect(loop);
+
+  f::RequestResult a = get(*connection);
+  f::RequestResult b = get(*connection);
+  connection->cancel();
+
+  ASSERT_EQ(a.error, f::Error::NoError);
+  ASSERT_EQ(a.response->payloadSize(), expected.size());
+  ASSERT_TRUE(a.response->payloadAsString() == expected);
+  ASSERT_EQ(b.error, f::Error::NoError);
+  ASSERT_TRUE(b.response->payloadAsString() == expected);
+  ASSERT_EQ(connection->bufferedBytes(), 0);
+}
+
+// the first request goes away while the rest of its large chunk is read in
+// place, the chunk is dropped and the next responses arrive unharmed
+void expectDroppedDuringRead(bool cancel) {
+  std::string body = patterned(bodySize);
+  // 16 slices, the timeout hits early on
+  ScriptedServer server(f::ProtocolType::Vst,
+                        {vstSingleChunkResponse(body),
+                         vstResponse(f::vst::VST1_1, "ok"),
+                         vstSingleChunkResponse(body)},
+                        sliceSize, std::chrono::milliseconds(40));
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Vst);
+  cbuilder.endpoint(server.endpoint());
+  auto connection = cbuilder.connect(loop);
+
+  f::WaitGroup wg;
+  wg.add(2);
+  f::Error errorA = f::Error::NoError, errorB = f::Error::Canceled;
+  std::unique_ptr<f::Response> responseB;
+  auto request = f::createRequest(f::RestVerb::Get, "/a");
+  if (!cancel) {
+    request->timeout(std::chrono::milliseconds(200));
+  }
+  f::MessageID mid = connection->sendRequest(
+      std::move(request), [&](f::Error e, std::unique_ptr<f::Request>,
+                              std::unique_ptr<f::Response>) {
+        errorA = e;
+        wg.done();
+      });
+  connection->sendRequest(f::createRequest(f::RestVerb::Get, "/b"),
+                          [&](f::Error e, std::unique_ptr<f::Request>,
+                              std::unique_ptr<f::Response> r) {
+                            errorB = e;
+                            responseB = std::move(r);
+                            wg.done();
+                          });
+  if (cancel) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    connection->cancelRequest(mid);
+  }
+  bool done = wg.wait_for(std::chrono::seconds(10));
+  f::RequestResult c = get(*connection);
+  connection->cancel();
+
+  ASSERT_TRUE(done);
+  ASSERT_EQ(errorA, cancel ? f::Error::Canceled : f::Error::Timeout);
+  ASSERT_EQ(errorB, f::Error::NoError);
+  ASSERT_EQ(responseB->payloadAsString(), "ok");
+  ASSERT_EQ(c.error, f::Error::NoError);
+  ASSERT_TRUE(c.response->payloadAsString() == body);
+  ASSERT_EQ(loop.bufferedBytes(), 0);
+}
+
+}  // namespace
+
+// the body of known length is read straight into the response buffer
+TEST(ReadInPlaceTest, HttpContentLength) {
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Http);
+  std::string body = patterned(bodySize);
+  expectLargeBodies(cbuilder, httpResponse(body), httpResponse(body), body);
+}
+
+// the rest of a large VST 1.1 chunk is read straight into its request item
+TEST(ReadInPlaceTest, Vst11LargeChunk) {
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Vst);
+  std::string body = patterned(bodySize);
+  expectLargeBodies(cbuilder, vstSingleChunkResponse(body),
+                    vstSingleChunkResponse(body), body);
+}
+
+TEST(ReadInPlaceTest, VstTimeoutDuringRead) { expectDroppedDuringRead(false); }
+
+TEST(ReadInPlaceTest, VstCancelDuringRead) { expectDroppedDuringRead(true); }
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include "ReceiveBuffer.h"
+#include <cstring>
+#include <string>
+
+namespace f = ::arangodb::fuerte;
+
+// unparsed bytes stay contiguous, the read size follows the reads
+TEST(ReceiveBufferTest, ContiguousAndAdaptive) {
+  f::ReceiveBuffer buffer;
+  ASSERT_EQ(buffer.capacity(), 0);
+
+  // full reads double the read size
+  auto space = buffer.prepare();
+  ASSERT_EQ(space.size(), f::ReceiveBuffer::initialReadSize);
+  std::memset(space.data(), 'a', space.size());
+  buffer.commit(space.size());
+  ASSERT_EQ(buffer.readSize(), 2 * f::ReceiveBuffer::initialReadSize);
+
+  // a partially parsed message is kept in one block
+  buffer.consume(buffer.size() - 10);
+  space = buffer.prepare();
+  std::memset(space.data(), 'b', 5);
+  buffer.commit(5);
+  auto data = buffer.data();
+  ASSERT_EQ(data.size(), 15);
+  auto const* p = static_cast<char const*>(data.data());
+  ASSERT_EQ(std::string(p, 15), std::string(10, 'a') + std::string(5, 'b'));
+
+  // small reads shrink it again
+  for (int i = 0; i < 32; i++) {
+    buffer.prepare();
+    buffer.commit(1);
+  }
+  ASSERT_LT(buffer.readSize(), 2 * f::ReceiveBuffer::initialReadSize);
+
+  // memory is only released without unparsed bytes
+  buffer.release();
+  ASSERT_GT(buffer.capacity(), 0);
+  buffer.consume(buffer.size());
+  buffer.release();
+  ASSERT_EQ(buffer.capacity(), 0);
+}
+
+// bytes of a read pending while the buffer is cleared are dropped
+TEST(ReceiveBufferTest, ClearDuringRead) {
+  f::ReceiveBuffer buffer;
+  auto space = buffer.prepare();
+  std::memset(space.data(), 'a', 10);
+  buffer.commit(10);
+  buffer.consume(4);
+
+  space = buffer.prepare();  // read into the space after the 6 bytes left
+  buffer.clear();            // connection shut down meanwhile
+  ASSERT_EQ(buffer.size(), 0);
+  buffer.release();  // the read still owns the memory
+  ASSERT_GT(buffer.capacity(), 0);
+  std::memset(space.data(), 'b', 5);
+  buffer.commit(5);  // completion of the old read
+  ASSERT_EQ(buffer.size(), 0);
+
+  space = buffer.prepare();
+  std::memset(space.data(), 'c', 3);
+  buffer.commit(3);
+  auto data = buffer.data();
+  ASSERT_EQ(std::string(static_cast<char const*>(data.data()), data.size()),
+            "ccc");
+  buffer.consume(3);
+  buffer.release();
+  ASSERT_EQ(buffer.capacity(), 0);
+}
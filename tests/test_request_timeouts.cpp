@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include <fuerte/fuerte.h>
+#include <fuerte/loop.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace f = ::arangodb::fuerte;
+
+namespace {
+
+// accepts one connection and reads nothing from it until resume(), then
+// reads until the client closes it. Never answers.
+class StalledServer {
+ public:
+  StalledServer()
+      : _acceptor(_io, asio_ns::ip::tcp::endpoint(
+                           asio_ns::ip::make_address("127.0.0.1"), 0)) {
+    _thread = std::thread([this] {
+      asio_ns::ip::tcp::socket socket(_io);
+      asio_ns::error_code ec;
+      _acceptor.accept(socket, ec);
+      {
+        std::unique_lock<std::mutex> guard(_mutex);
+        _cv.wait(guard, [this] { return _resumed.load(); });
+      }
+      std::vector<char> buffer(64 * 1024);
+      while (!ec) {
+        socket.read_some(asio_ns::buffer(buffer), ec);
+      }
+    });
+  }
+
+  ~StalledServer() {
+    resume();
+    _thread.join();
+  }
+
+  std::string endpoint(std::string const& scheme = "vst") const {
+    return scheme + "://127.0.0.1:" +
+           std::to_string(_acceptor.local_endpoint().port());
+  }
+
+  void resume() {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _resumed.store(true);
+    _cv.notify_all();
+  }
+
+  bool resumed() const { return _resumed.load(); }
+
+ private:
+  asio_ns::io_context _io;
+  asio_ns::ip::tcp::acceptor _acceptor;
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::atomic<bool> _resumed{false};
+  std::thread _thread;
+};
+
+}  // namespace
+
+// a VST request expiring while its chunks are written keeps its payload
+// until the write is done, only then the callback gets it back
+TEST(RequestTimeoutTest, VstExpiresDuringWrite) {
+  StalledServer server;
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint(server.endpoint());
+  auto connection = cbuilder.connect(loop);
+
+  // waits for an answer, so the connection stays open
+  f::WaitGroup wg;
+  wg.add();
+  auto pending = f::createRequest(f::RestVerb::Get, "/_api/version");
+  connection->sendRequest(std::move(pending),
+                          [&](f::Error, std::unique_ptr<f::Request>,
+                              std::unique_ptr<f::Response>) { wg.done(); });
+
+  // many chunks, more than the socket buffers take without a reader
+  auto request = f::createRequest(f::RestVerb::Post, "/_api/document/c");
+  std::vector<uint8_t> body(32 * 1024 * 1024, 'r');
+  request->addBinary(body.data(), body.size());
+  request->timeout(std::chrono::milliseconds(100));
+
+  f::WaitGroup expired;
+  expired.add();
+  f::Error error = f::Error::NoError;
+  bool whileStalled = false;
+  connection->sendRequest(std::move(request),
+                          [&](f::Error e, std::unique_ptr<f::Request> req,
+                              std::unique_ptr<f::Response>) {
+                            f::WaitGroupDone done(expired);
+                            error = e;
+                            whileStalled = !server.resumed();
+                          });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  server.resume();
+  bool finished = expired.wait_for(std::chrono::seconds(10));
+  connection->cancel();
+  ASSERT_TRUE(wg.wait_for(std::chrono::seconds(5)));
+
+  ASSERT_TRUE(finished);
+  ASSERT_EQ(error, f::Error::Timeout);
+  ASSERT_FALSE(whileStalled);  // not while the write used the request
+}
+
+// a request queued behind one that never gets an answer fails at its
+// deadline, it does not wait until it is dequeued
+TEST(RequestTimeoutTest, HttpExpiresInQueue) {
+  StalledServer server;
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint(server.endpoint("http"));
+  auto connection = cbuilder.connect(loop);
+
+  // written, but never answered, the next one has to wait for it
+  f::WaitGroup wg;
+  wg.add();
+  auto pending = f::createRequest(f::RestVerb::Get, "/_api/version");
+  connection->sendRequest(std::move(pending),
+                          [&](f::Error, std::unique_ptr<f::Request>,
+                              std::unique_ptr<f::Response>) { wg.done(); });
+
+  auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+  request->timeout(std::chrono::milliseconds(100));
+  f::WaitGroup expired;
+  expired.add();
+  f::Error error = f::Error::NoError;
+  bool whileStalled = false;
+  bool gotRequest = false;
+  connection->sendRequest(std::move(request),
+                          [&](f::Error e, std::unique_ptr<f::Request> req,
+                              std::unique_ptr<f::Response>) {
+                            f::WaitGroupDone done(expired);
+                            error = e;
+                            gotRequest = req != nullptr;
+                            whileStalled = !server.resumed();
+                          });
+
+  bool finished = expired.wait_for(std::chrono::seconds(5));
+  server.resume();
+  connection->cancel();
+  ASSERT_TRUE(wg.wait_for(std::chrono::seconds(5)));
+
+  ASSERT_TRUE(finished);
+  ASSERT_EQ(error, f::Error::Timeout);
+  ASSERT_TRUE(gotRequest);
+  ASSERT_TRUE(whileStalled);  // the first request still holds the line
+}
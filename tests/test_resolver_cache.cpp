@@ -0,0 +1,215 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include "AsioSockets.h"
+#include "ResolverCache.h"
+#include <fuerte/fuerte.h>
+#include <fuerte/loop.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace f = ::arangodb::fuerte;
+
+// failed lookups are cached, so repeated connects fail without resolving
+TEST(ResolverCacheTest, NegativeCaching) {
+  using std::chrono::milliseconds;
+  f::ResolverCache cache;
+  f::ResolverCache::Endpoints eps;
+  asio_ns::error_code ec;
+  ASSERT_FALSE(cache.lookup("nohost", "8529", milliseconds(0),
+                            milliseconds(50), eps, ec));
+
+  cache.store("nohost", "8529", {}, asio_ns::error::host_not_found);
+  ASSERT_TRUE(cache.lookup("nohost", "8529", milliseconds(0),
+                           milliseconds(50), eps, ec));
+  ASSERT_EQ(ec, asio_ns::error::host_not_found);
+  ASSERT_TRUE(eps.empty());
+
+  std::this_thread::sleep_for(milliseconds(60));
+  ASSERT_FALSE(cache.lookup("nohost", "8529", milliseconds(0),
+                            milliseconds(50), eps, ec));
+}
+
+// every caller applies its own ttl, not the one of the first connection
+// that stored the entry
+TEST(ResolverCacheTest, TtlOfCaller) {
+  using std::chrono::milliseconds;
+  f::ResolverCache cache;
+  f::ResolverCache::Endpoints eps;
+  asio_ns::error_code ec;
+  asio_ns::ip::tcp::endpoint ep(asio_ns::ip::make_address("127.0.0.1"), 1);
+  cache.store("host", "8529", {ep}, asio_ns::error_code());
+
+  std::this_thread::sleep_for(milliseconds(20));
+  ASSERT_FALSE(
+      cache.lookup("host", "8529", milliseconds(10), milliseconds(0), eps, ec));
+  ASSERT_FALSE(
+      cache.lookup("host", "8529", milliseconds(0), milliseconds(0), eps, ec));
+  ASSERT_TRUE(cache.lookup("host", "8529", milliseconds(60000),
+                           milliseconds(0), eps, ec));
+  ASSERT_FALSE(ec);
+  ASSERT_EQ(eps, f::ResolverCache::Endpoints{ep});
+}
+
+// address families are interleaved, starting with the first family
+TEST(ResolverCacheTest, InterleaveFamilies) {
+  using tcp = asio_ns::ip::tcp;
+  auto v4 = asio_ns::ip::make_address("127.0.0.1");
+  auto v6 = asio_ns::ip::make_address("::1");
+  f::ResolverCache::Endpoints eps{tcp::endpoint(v6, 1), tcp::endpoint(v6, 2),
+                                  tcp::endpoint(v6, 3), tcp::endpoint(v4, 4),
+                                  tcp::endpoint(v4, 5)};
+  auto result = f::interleaveFamilies(eps);
+  ASSERT_EQ(result.size(), eps.size());
+  std::vector<unsigned short> ports;
+  for (auto const& ep : result) {
+    ports.push_back(ep.port());
+  }
+  ASSERT_EQ(ports, (std::vector<unsigned short>{1, 4, 2, 5, 3}));
+}
+
+// addresses that refuse all connections are forgotten, the next attempt
+// resolves the host again
+TEST(ResolverCacheTest, InvalidateStaleEndpoints) {
+  using tcp = asio_ns::ip::tcp;
+  asio_ns::io_context io;
+  tcp::acceptor acceptor(io, tcp::endpoint(tcp::v4(), 0));
+  tcp::endpoint stale;
+  {
+    tcp::acceptor closed(io, tcp::endpoint(tcp::v4(), 0));
+    stale = tcp::endpoint(asio_ns::ip::make_address("127.0.0.1"),
+                          closed.local_endpoint().port());
+  }
+  std::string port = std::to_string(acceptor.local_endpoint().port());
+  tcp::socket socket(io);
+  asio_ns::streambuf buffer;
+  std::string const response =
+      "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+  acceptor.async_accept(socket, [&](asio_ns::error_code const& ec) {
+    if (ec) {
+      return;
+    }
+    asio_ns::async_read_until(
+        socket, buffer, "\r\n\r\n",
+        [&](asio_ns::error_code const& ec, size_t) {
+          if (!ec) {  // answers a single request
+            asio_ns::async_write(socket, asio_ns::buffer(response),
+                                 [](asio_ns::error_code const&, size_t) {});
+          }
+        });
+  });
+  std::thread server([&] { io.run_for(std::chrono::seconds(5)); });
+
+  f::EventLoopService loop;
+  loop.resolverCache().store("localhost", port, {stale},
+                             asio_ns::error_code());
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint("http://localhost:" + port);
+  auto connection = cbuilder.connect(loop);
+  auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+  f::RequestResult result =
+      connection->sendRequest(std::move(request), std::nothrow);
+  connection->cancel();  // do not wait for the idle timeout
+  server.join();
+
+  ASSERT_EQ(result.error, f::Error::NoError);
+  f::ResolverCache::Endpoints eps;
+  asio_ns::error_code ec;
+  ASSERT_TRUE(loop.resolverCache().lookup("localhost", port,
+                                          std::chrono::seconds(60),
+                                          std::chrono::seconds(1), eps, ec));
+  ASSERT_FALSE(ec);
+  ASSERT_EQ(std::count(eps.begin(), eps.end(), stale), 0);
+}
+
+// once connected, dropping the last reference destroys the connection
+TEST(ResolverCacheTest, ConnectKeepsNoReference) {
+  using tcp = asio_ns::ip::tcp;
+  asio_ns::io_context io;
+  tcp::acceptor acceptor(io, tcp::endpoint(tcp::v4(), 0));
+  std::string port = std::to_string(acceptor.local_endpoint().port());
+  tcp::socket socket(io);
+  asio_ns::streambuf buffer;
+  std::string const response =
+      "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+  acceptor.async_accept(socket, [&](asio_ns::error_code const& ec) {
+    if (ec) {
+      return;
+    }
+    asio_ns::async_read_until(
+        socket, buffer, "\r\n\r\n",
+        [&](asio_ns::error_code const& ec, size_t) {
+          if (!ec) {  // answers a single request
+            asio_ns::async_write(socket, asio_ns::buffer(response),
+                                 [](asio_ns::error_code const&, size_t) {});
+          }
+        });
+  });
+  std::thread server([&] { io.run_for(std::chrono::seconds(2)); });
+
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint("http://127.0.0.1:" + port);
+  auto connection = cbuilder.connect(loop);
+  auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+  f::RequestResult result =
+      connection->sendRequest(std::move(request), std::nothrow);
+  std::weak_ptr<f::Connection> weak = connection;
+  connection.reset();  // no cancel(), the idle timer is running
+  for (int i = 0; i < 100 && !weak.expired(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  server.join();
+
+  ASSERT_EQ(result.error, f::Error::NoError);
+  ASSERT_TRUE(weak.expired());
+}
+
+// canceling while the connect is pending must not touch the freed socket
+TEST(ResolverCacheTest, CancelWhileConnecting) {
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint("http://10.255.255.1:8529");  // drops the SYN
+  std::weak_ptr<f::Connection> weak;
+  std::atomic<bool> done(false);
+  f::Error error = f::Error::NoError;
+  {
+    auto connection = cbuilder.connect(loop);
+    weak = connection;
+    auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+    connection->sendRequest(
+        std::move(request), [&](f::Error e, std::unique_ptr<f::Request>,
+                                std::unique_ptr<f::Response>) {
+          error = e;
+          done.store(true);
+        });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    connection->cancel();  // the attempt is still in flight
+  }
+  for (int i = 0; i < 100 && (!done.load() || !weak.expired()); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_TRUE(done.load());
+  ASSERT_NE(error, f::Error::NoError);
+  ASSERT_TRUE(weak.expired());
+}
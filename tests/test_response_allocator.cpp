@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+#include "scripted_server.h"
+
+#include <fuerte/fuerte.h>
+#include <fuerte/loop.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace f = ::arangodb::fuerte;
+
+namespace {
+
+// heap storage that keeps track of what is handed out, or none at all
+struct TrackingAllocator final : public f::PayloadAllocator {
+  explicit TrackingAllocator(bool decline = false) : decline(decline) {}
+
+  uint8_t* allocate(std::size_t size) override {
+    calls++;
+    if (decline) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    blocks.emplace_back(new uint8_t[size], size);
+    return blocks.back().first;
+  }
+
+  void deallocate(uint8_t* data, std::size_t size) noexcept override {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+      if (it->first == data && it->second == size) {
+        delete[] data;
+        blocks.erase(it);
+        return;
+      }
+    }
+    unknown++;
+  }
+
+  // a live block holds exactly these bytes
+  bool holds(void const* data, std::size_t size) {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto const& block : blocks) {
+      if (block.first == data && block.second == size) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::size_t live() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return blocks.size();
+  }
+
+  bool const decline;
+  std::atomic<std::size_t> calls{0};
+  std::size_t unknown = 0;  // deallocate() of foreign storage
+  std::mutex mutex;
+  std::vector<std::pair<uint8_t*, std::size_t>> blocks;
+};
+
+std::string patterned(std::size_t size) {
+  std::string body(size, '\0');
+  for (std::size_t i = 0; i < size; i++) {
+    body[i] = static_cast<char>(i % 251);
+  }
+  return body;
+}
+
+f::RequestResult get(f::ConnectionBuilder& cbuilder,
+                     ScriptedServer::Response response,
+                     std::shared_ptr<f::PayloadAllocator> allocator,
+                     std::size_t sliceSize = 0) {
+  ScriptedServer server(cbuilder.protocolType(), {std::move(response)},
+                        sliceSize, std::chrono::milliseconds(2));
+  f::EventLoopService loop;
+  cbuilder.endpoint(server.endpoint());
+  auto connection = cbuilder.connect(loop);
+  auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+  request->responseAllocator(std::move(allocator));
+  f::RequestResult result =
+      connection->sendRequest(std::move(request), std::nothrow);
+  connection->cancel();
+  return result;
+}
+
+// the body ends up in storage of the allocator, which gets it back once the
+// response and all slices of it are gone
+void expectAllocated(f::ConnectionBuilder& cbuilder,
+                     ScriptedServer::Response response,
+                     std::string const& body, std::size_t sliceSize = 0) {
+  auto allocator = std::make_shared<TrackingAllocator>();
+  f::RequestResult result = get(cbuilder, std::move(response), allocator,
+                                sliceSize);
+  ASSERT_EQ(result.error, f::Error::NoError);
+  ASSERT_TRUE(result.response->payloadAsString() == body);
+  ASSERT_EQ(allocator->calls, 1);
+  ASSERT_TRUE(allocator->holds(result.response->payload().data(),
+                               body.size()));
+
+  f::PayloadSlice slice = result.response->sharePayload();
+  result.response.reset();
+  ASSERT_EQ(allocator->live(), 1);
+  ASSERT_EQ(std::string(reinterpret_cast<char const*>(slice.data()),
+                        slice.size()),
+            body);
+  slice = f::PayloadSlice();
+  ASSERT_EQ(allocator->live(), 0);
+  ASSERT_EQ(allocator->unknown, 0);
+}
+
+// an allocator returning nullptr leaves the body in a default buffer
+void expectDeclined(f::ConnectionBuilder& cbuilder,
+                    ScriptedServer::Response response,
+                    std::string const& body) {
+  auto allocator = std::make_shared<TrackingAllocator>(/*decline*/ true);
+  f::RequestResult result = get(cbuilder, std::move(response), allocator);
+  ASSERT_EQ(result.error, f::Error::NoError);
+  ASSERT_TRUE(result.response->payloadAsString() == body);
+  ASSERT_EQ(allocator->calls, 1);
+  result.response.reset();
+  ASSERT_EQ(allocator->unknown, 0);
+}
+
+}  // namespace
+
+// a body of known length is received straight into the storage
+TEST(ResponseAllocatorTest, HttpContentLength) {
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Http);
+  std::string body = patterned(1000);
+  expectAllocated(cbuilder, httpResponse(body), body);
+}
+
+// also when the rest of it is read in place
+TEST(ResponseAllocatorTest, HttpContentLengthInPlace) {
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Http);
+  std::string body = patterned(256 * 1024);
+  expectAllocated(cbuilder, httpResponse(body), body, 16 * 1024);
+}
+
+// a chunked body is copied to the storage once it is complete
+TEST(ResponseAllocatorTest, HttpChunked) {
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Http);
+  std::string body = patterned(100 * 1024);
+  expectAllocated(cbuilder,
+                  httpChunkedResponse({body.substr(0, 1000),
+                                       body.substr(1000, 50 * 1024),
+                                       body.substr(1000 + 50 * 1024)}),
+                  body, 16 * 1024);
+}
+
+// a VST response is copied to the storage once all chunks are there
+TEST(ResponseAllocatorTest, Vst) {
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Vst);
+  std::string body = patterned(100 * 1024);  // several chunks
+  expectAllocated(cbuilder, vstResponse(f::vst::VST1_1, body), body,
+                  16 * 1024);
+}
+
+// also after its single chunk was read in place
+TEST(ResponseAllocatorTest, VstInPlace) {
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Vst);
+  std::string body = patterned(256 * 1024);
+  expectAllocated(
+      cbuilder,
+      [body](uint64_t messageID) { return vstSingleChunk(messageID, body); },
+      body, 16 * 1024);
+}
+
+TEST(ResponseAllocatorTest, Declined) {
+  std::string body = patterned(1000);
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Http);
+  expectDeclined(cbuilder, httpResponse(body), body);
+  expectDeclined(cbuilder, httpChunkedResponse({body}), body);
+  cbuilder.protocolType(f::ProtocolType::Vst);
+  expectDeclined(cbuilder, vstResponse(f::vst::VST1_1, body), body);
+}
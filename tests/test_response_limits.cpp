@@ -0,0 +1,181 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+#include "scripted_server.h"
+
+#include <fuerte/fuerte.h>
+#include <fuerte/loop.h>
+#include <memory>
+#include <vector>
+
+namespace f = ::arangodb::fuerte;
+
+namespace {
+
+f::RequestResult get(f::Connection& connection) {
+  auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+  return connection.sendRequest(std::move(request), std::nothrow);
+}
+
+// the first response is rejected with `expected`, the next one on the same
+// connection object arrives unharmed
+void expectRejectedThenOk(f::EventLoopService& loop,
+                          f::ConnectionBuilder& cbuilder,
+                          ScriptedServer::Response rejected,
+                          ScriptedServer::Response ok,
+                          f::Error expected) {
+  ScriptedServer server(cbuilder.protocolType(),
+                        {std::move(rejected), std::move(ok)});
+  cbuilder.endpoint(server.endpoint());
+  auto connection = cbuilder.connect(loop);
+
+  f::RequestResult first = get(*connection);
+  std::size_t bufferedAfterReject = connection->bufferedBytes();
+  f::RequestResult result = get(*connection);
+  connection->cancel();  // do not wait for the idle timeout
+
+  ASSERT_EQ(first.error, expected);
+  ASSERT_EQ(bufferedAfterReject, 0);
+  ASSERT_EQ(result.error, f::Error::NoError);
+  ASSERT_EQ(result.response->statusCode(), f::StatusOK);
+  ASSERT_EQ(result.response->payloadAsString(), "ok");
+  ASSERT_EQ(connection->bufferedBytes(), 0);
+  ASSERT_EQ(loop.bufferedBytes(), 0);
+}
+
+}  // namespace
+
+// a body of known length is rejected before any of it is buffered
+TEST(ResponseLimitsTest, HttpContentLength) {
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Http);
+  cbuilder.maxResponseSize(1000);
+  expectRejectedThenOk(loop, cbuilder, httpResponse(std::string(2000, 'x')),
+                       httpResponse("ok"), f::Error::ResponseTooLarge);
+}
+
+// a chunked body is rejected once it grows over the limit, nothing of it
+// is left for the next response
+TEST(ResponseLimitsTest, HttpChunked) {
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Http);
+  cbuilder.maxResponseSize(1000);
+  expectRejectedThenOk(
+      loop, cbuilder,
+      httpChunkedResponse({std::string(600, 'x'), std::string(600, 'y')}),
+      httpResponse("ok"), f::Error::ResponseTooLarge);
+}
+
+// the budget of the connection and the one of the loop are both enforced
+TEST(ResponseLimitsTest, HttpMemoryBudget) {
+  {
+    f::EventLoopService loop;
+    f::ConnectionBuilder cbuilder;
+    cbuilder.protocolType(f::ProtocolType::Http);
+    cbuilder.memoryBudget(1000);
+    expectRejectedThenOk(loop, cbuilder,
+                         httpResponse(std::string(2000, 'x')),
+                         httpResponse("ok"), f::Error::MemoryBudgetExceeded);
+  }
+  {
+    f::LoopOptions options;
+    options.memoryBudget = 1000;
+    f::EventLoopService loop(options);
+    f::ConnectionBuilder cbuilder;
+    cbuilder.protocolType(f::ProtocolType::Http);
+    expectRejectedThenOk(
+        loop, cbuilder,
+        httpChunkedResponse({std::string(600, 'x'), std::string(600, 'y')}),
+        httpResponse("ok"), f::Error::MemoryBudgetExceeded);
+  }
+}
+
+// a VST 1.1 chunk header announces the message length, the response is
+// rejected before its body arrives and the rest of the chunk is skipped
+TEST(ResponseLimitsTest, Vst11ChunkHeader) {
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Vst);
+  cbuilder.maxResponseSize(1000);
+
+  auto rest = std::make_shared<std::string>();
+  auto partial = [rest](uint64_t messageID) {
+    std::string message =
+        vstMessage(f::vst::VST1_1, messageID, std::string(2000, 'x'));
+    *rest = message.substr(100);
+    return message.substr(0, 100);
+  };
+  auto restThenOk = [rest](uint64_t messageID) {
+    return *rest + vstMessage(f::vst::VST1_1, messageID, "ok");
+  };
+  expectRejectedThenOk(loop, cbuilder, partial, restThenOk,
+                       f::Error::ResponseTooLarge);
+}
+
+// VST 1.0 chunks are checked once they are complete
+TEST(ResponseLimitsTest, Vst10CompleteChunk) {
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Vst);
+  cbuilder.vstVersion(f::vst::VST1_0);
+  cbuilder.maxResponseSize(1000);
+  expectRejectedThenOk(loop, cbuilder,
+                       vstResponse(f::vst::VST1_0, std::string(2000, 'x')),
+                       vstResponse(f::vst::VST1_0, "ok"),
+                       f::Error::ResponseTooLarge);
+}
+
+TEST(ResponseLimitsTest, VstMemoryBudget) {
+  f::LoopOptions options;
+  options.memoryBudget = 1000;
+  f::EventLoopService loop(options);
+  f::ConnectionBuilder cbuilder;
+  cbuilder.protocolType(f::ProtocolType::Vst);
+  expectRejectedThenOk(loop, cbuilder,
+                       vstResponse(f::vst::VST1_1, std::string(2000, 'x')),
+                       vstResponse(f::vst::VST1_1, "ok"),
+                       f::Error::MemoryBudgetExceeded);
+}
+
+// a response rejected while its request is still being written reports the
+// limit, not a cancellation
+TEST(ResponseLimitsTest, VstRejectedDuringWrite) {
+  ScriptedServer server(
+      f::ProtocolType::Vst,
+      {vstResponse(f::vst::VST1_1, std::string(2000, 'x'))});
+  f::EventLoopService loop;
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint(server.endpoint());
+  cbuilder.maxResponseSize(1000);
+  auto connection = cbuilder.connect(loop);
+
+  auto request = f::createRequest(f::RestVerb::Post, "/_api/document/c");
+  std::vector<uint8_t> body(32 * 1024 * 1024, 'r');
+  request->addBinary(body.data(), body.size());
+  f::RequestResult result =
+      connection->sendRequest(std::move(request), std::nothrow);
+  connection->cancel();
+
+  ASSERT_EQ(result.error, f::Error::ResponseTooLarge);
+  ASSERT_EQ(loop.bufferedBytes(), 0);
+}
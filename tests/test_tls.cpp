@@ -0,0 +1,210 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include <fuerte/fuerte.h>
+#include <fuerte/loop.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace f = ::arangodb::fuerte;
+
+namespace {
+
+// self-signed certificate and key in PEM format
+struct TestCertificate {
+  std::string cert;
+  std::string key;
+};
+
+std::string toPem(int (*write)(BIO*, void*), void* obj) {
+  BIO* bio = BIO_new(BIO_s_mem());
+  write(bio, obj);
+  char* data = nullptr;
+  long len = BIO_get_mem_data(bio, &data);
+  std::string pem(data, len);
+  BIO_free(bio);
+  return pem;
+}
+
+TestCertificate makeCertificate(std::string const& commonName) {
+  EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+  EVP_PKEY_keygen_init(pctx);
+  EVP_PKEY_CTX_set_ec_paramgen_curve_nid(pctx, NID_X9_62_prime256v1);
+  EVP_PKEY* pkey = nullptr;
+  EVP_PKEY_keygen(pctx, &pkey);
+  EVP_PKEY_CTX_free(pctx);
+
+  X509* x509 = X509_new();
+  X509_set_version(x509, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+  X509_gmtime_adj(X509_getm_notBefore(x509), 0);
+  X509_gmtime_adj(X509_getm_notAfter(x509), 3600);
+  X509_set_pubkey(x509, pkey);
+  X509_NAME* name = X509_get_subject_name(x509);
+  X509_NAME_add_entry_by_txt(
+      name, "CN", MBSTRING_ASC,
+      reinterpret_cast<unsigned char const*>(commonName.c_str()), -1, -1, 0);
+  X509_set_issuer_name(x509, name);
+  X509_sign(x509, pkey, EVP_sha256());
+
+  TestCertificate result;
+  result.cert = toPem(
+      [](BIO* bio, void* x) {
+        return PEM_write_bio_X509(bio, static_cast<X509*>(x));
+      },
+      x509);
+  result.key = toPem(
+      [](BIO* bio, void* k) {
+        return PEM_write_bio_PrivateKey(bio, static_cast<EVP_PKEY*>(k), nullptr,
+                                        nullptr, 0, nullptr, nullptr);
+      },
+      pkey);
+  X509_free(x509);
+  EVP_PKEY_free(pkey);
+  return result;
+}
+
+// answers every request on a TLS connection with an empty 200
+class TlsServer {
+ public:
+  explicit TlsServer(TestCertificate const& cert)
+      : _ssl(asio_ns::ssl::context::tls_server),
+        _acceptor(_io, asio_ns::ip::tcp::endpoint(
+                           asio_ns::ip::make_address("127.0.0.1"), 0)),
+        _work(asio_ns::make_work_guard(_io)) {
+    _ssl.use_certificate(asio_ns::buffer(cert.cert),
+                         asio_ns::ssl::context::pem);
+    _ssl.use_private_key(asio_ns::buffer(cert.key),
+                         asio_ns::ssl::context::pem);
+    accept();
+    _thread = std::thread([this] { _io.run(); });
+  }
+
+  ~TlsServer() {
+    asio_ns::post(_io, [this] {
+      _acceptor.close();
+      _work.reset();
+      _io.stop();
+    });
+    _thread.join();
+  }
+
+  unsigned short port() const { return _acceptor.local_endpoint().port(); }
+
+  /// @brief handshakes that resumed a session
+  std::atomic<int> resumed{0};
+
+ private:
+  struct Session {
+    Session(asio_ns::io_context& io, asio_ns::ssl::context& ssl)
+        : stream(io, ssl) {}
+    asio_ns::ssl::stream<asio_ns::ip::tcp::socket> stream;
+    asio_ns::streambuf buffer;
+  };
+
+  void accept() {
+    auto s = std::make_shared<Session>(_io, _ssl);
+    _acceptor.async_accept(s->stream.lowest_layer(),
+                           [this, s](asio_ns::error_code const& ec) {
+      if (ec) {
+        return;
+      }
+      s->stream.async_handshake(
+          asio_ns::ssl::stream_base::server,
+          [this, s](asio_ns::error_code const& ec) {
+            if (ec) {
+              return;
+            }
+            if (SSL_session_reused(s->stream.native_handle())) {
+              resumed++;
+            }
+            read(s);
+          });
+      accept();
+    });
+  }
+
+  void read(std::shared_ptr<Session> s) {
+    asio_ns::async_read_until(
+        s->stream, s->buffer, "\r\n\r\n",
+        [this, s](asio_ns::error_code const& ec, size_t n) {
+          if (ec) {
+            return;
+          }
+          s->buffer.consume(n);
+          static std::string const response =
+              "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+          asio_ns::async_write(s->stream, asio_ns::buffer(response),
+                               [this, s](asio_ns::error_code const& ec,
+                                         size_t) {
+                                 if (!ec) {
+                                   read(s);
+                                 }
+                               });
+        });
+  }
+
+  asio_ns::io_context _io;
+  asio_ns::ssl::context _ssl;
+  asio_ns::ip::tcp::acceptor _acceptor;
+  asio_ns::executor_work_guard<asio_ns::io_context::executor_type> _work;
+  std::thread _thread;
+};
+
+}  // namespace
+
+// verified connections succeed and resume their session on reconnect
+TEST(TlsTest, VerifyHostAndResume) {
+  TestCertificate cert = makeCertificate("localhost");
+  TlsServer server(cert);
+
+  f::EventLoopService loop;
+  loop.sslContext().add_certificate_authority(asio_ns::buffer(cert.cert));
+
+  f::ConnectionBuilder cbuilder;
+  cbuilder.endpoint("ssl://localhost:" + std::to_string(server.port()));
+  cbuilder.verifyHost(true);
+
+  for (int i = 0; i < 2; i++) {
+    auto connection = cbuilder.connect(loop);
+    auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+    auto response = connection->sendRequest(std::move(request));
+    ASSERT_EQ(response->statusCode(), f::StatusOK);
+    connection->cancel();  // do not wait for the idle timeout
+  }
+  ASSERT_EQ(server.resumed.load(), 1);
+
+  // a certificate for another host is rejected
+  TestCertificate other = makeCertificate("otherhost");
+  TlsServer wrong(other);
+  loop.sslContext().add_certificate_authority(asio_ns::buffer(other.cert));
+  cbuilder.endpoint("ssl://localhost:" + std::to_string(wrong.port()));
+  auto connection = cbuilder.connect(loop);
+  auto request = f::createRequest(f::RestVerb::Get, "/_api/version");
+  f::RequestResult result =
+      connection->sendRequest(std::move(request), std::nothrow);
+  ASSERT_EQ(result.error, f::Error::CouldNotConnect);
+  connection->cancel();
+}
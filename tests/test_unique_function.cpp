@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2019 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "test_main.h"
+
+#include <fuerte/unique_function.h>
+#include <array>
+#include <functional>
+#include <memory>
+
+namespace f = ::arangodb::fuerte;
+
+// move-only captures work, small callables are kept inline
+TEST(UniqueFunctionTest, MoveOnlyCallable) {
+  auto ptr = std::make_unique<int>(42);
+  f::unique_function<int(int)> fn = [p = std::move(ptr)](int x) {
+    return *p + x;
+  };
+  ASSERT_TRUE(fn);
+  ASSERT_EQ(fn(1), 43);
+
+  f::unique_function<int(int)> moved = std::move(fn);
+  ASSERT_FALSE(fn);
+  ASSERT_EQ(moved(2), 44);
+
+  // too large for the inline buffer
+  std::array<char, 2 * f::unique_function<int(int)>::inlineSize> big{};
+  big[0] = 1;
+  moved = [big](int x) { return big[0] + x; };
+  ASSERT_EQ(moved(1), 2);
+
+  // an empty std::function stays empty
+  std::function<int(int)> empty;
+  f::unique_function<int(int)> none = empty;
+  ASSERT_FALSE(none);
+  ASSERT_THROW(none(1), std::bad_function_call);
+}
@@ -24,6 +24,8 @@
 #include "vst.h"
 #include "Basics/Format.h"
 #include <velocypack/velocypack-aliases.h>
+#include <algorithm>
+#include <cstring>
 
 namespace fu = ::arangodb::fuerte;
 
@@ -245,3 +247,74 @@ TEST(VelocyStream_11, prepareForNetworkMultipleChunks) {
   ASSERT_EQ(result[6].size(), expectedLength2);
   ASSERT_EQ(data.substr(expectedLength1, expectedLength2), std::string(reinterpret_cast<char const*>(result[6].data()), result[6].size()));
 }
+
+TEST(VelocyStream_11, prepareForNetworkSegments) {
+  fu::vst::VSTVersion vstVersion = fu::vst::VSTVersion::VST1_1;
+  fu::vst::MessageID messageId(4321);
+
+  std::string prefix(16, 'a');
+  VPackBuffer<uint8_t> buffer;
+  buffer.append(prefix.data(), prefix.size());
+
+  // the second chunk starts inside the first segment and ends in the third
+  std::string first(fu::vst::defaultMaxChunkSize, 'b');
+  std::string second(100, 'c');
+  std::string third(fu::vst::defaultMaxChunkSize, 'd');
+  std::vector<asio_ns::const_buffer> payload;
+  payload.emplace_back(first.data(), first.size());
+  payload.emplace_back(second.data(), second.size());
+  payload.emplace_back(nullptr, 0);
+  payload.emplace_back(third.data(), third.size());
+
+  std::vector<asio_ns::const_buffer> result;
+  std::vector<std::size_t> chunkStarts;
+  fu::vst::message::prepareForNetwork(vstVersion, messageId, buffer, payload,
+                                      result, &chunkStarts);
+  ASSERT_EQ(chunkStarts.size(), 3);
+
+  std::string joined;
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < result.size(); ++i) {
+    bool isHeader = std::find(chunkStarts.begin(), chunkStarts.end(), i) !=
+                    chunkStarts.end();
+    total += result[i].size();
+    if (!isHeader && i != 1) {  // result[1] is the message header
+      joined.append(static_cast<char const*>(result[i].data()),
+                    result[i].size());
+    }
+  }
+  ASSERT_EQ(joined, first + second + third);
+  ASSERT_EQ(total, 3 * fu::vst::maxChunkHeaderSize + prefix.size() +
+                       first.size() + second.size() + third.size());
+  // the segments are referenced in place
+  ASSERT_EQ(result[2].data(), first.data());
+  ASSERT_EQ(result[chunkStarts[1] + 2].data(), second.data());
+}
+
+TEST(VelocyStream_11, addPartialChunk) {
+  std::string head(100, 'h');
+  std::string rest(3 * fu::vst::defaultMaxChunkSize, 'r');
+
+  fu::vst::Chunk chunk;
+  chunk.header._chunkLength = static_cast<uint32_t>(
+      fu::vst::maxChunkHeaderSize + head.size() + rest.size());
+  chunk.header._chunkX = (1 << 1) | 1;  // first and only chunk
+  chunk.header._messageID = 1;
+  chunk.header._messageLength = head.size() + rest.size();
+  chunk.body = asio_ns::const_buffer(head.data(), head.size());
+
+  // the rest of the body is read straight into the item
+  fu::vst::RequestItem item;
+  asio_ns::mutable_buffer target =
+      item.addPartialChunk(chunk, head.size() + rest.size());
+  ASSERT_EQ(target.size(), rest.size());
+  ASSERT_EQ(target.data(), item._buffer.data() + head.size());
+  std::memcpy(target.data(), rest.data(), rest.size());
+  item._buffer.advance(rest.size());
+
+  auto buffer = item.assemble();
+  ASSERT_NE(buffer, nullptr);
+  ASSERT_EQ(std::string(reinterpret_cast<char const*>(buffer->data()),
+                        buffer->size()),
+            head + rest);
+}